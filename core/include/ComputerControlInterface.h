@@ -25,6 +25,9 @@
 #ifndef COMPUTER_CONTROL_INTERFACE_H
 #define COMPUTER_CONTROL_INTERFACE_H
 
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
 #include <QList>
 #include <QObject>
 #include <QSize>
@@ -34,6 +37,7 @@
 #include "VeyonCore.h"
 
 class QImage;
+class QTimer;
 
 class BuiltinFeatures;
 class FeatureMessage;
@@ -71,6 +75,9 @@ public:
 		return m_computer;
 	}
 
+	/** \brief Updates the computer's data, reconnects immediately if the host address changed or after failures */
+	void setComputer( const Computer& computer );
+
 	State state() const
 	{
 		return m_state;
@@ -85,16 +92,41 @@ public:
 
 	QImage scaledScreen() const;
 
+	/** \brief Returns the current screen in full resolution if available without delay, a null image otherwise */
 	QImage screen() const;
 
-	bool hasScreenUpdates() const
+	/*!
+	 * \brief Emits fullResolutionScreenGrabbed() once the screen is available in full resolution
+	 *
+	 * Thumbnail connections scaled by the server or with paused updates do not provide the screen
+	 * in full resolution. A temporary connection is established in this case. The signal may be
+	 * emitted before this method returns.
+	 */
+	void grabFullResolutionScreen();
+
+	bool areUpdatesPaused() const
 	{
-		return m_screenUpdated;
+		return m_updatesPaused;
 	}
 
-	void clearScreenUpdateFlag()
+	void setUpdatesPaused( bool paused );
+
+	/** \brief Prefers this computer when sharing network bandwidth, e.g. while selected by the user */
+	void setFocused( bool focused );
+
+	void resetReconnectBackoff();
+
+	/** \brief Returns the average fraction of the screen changed per second in permille */
+	int screenActivity() const;
+
+	/** \brief Returns performance statistics of the VNC connection, see VncConnectionStatistics */
+	QJsonObject connectionStatistics() const;
+	QString connectionStatisticsSummary() const;
+
+	/** \brief Returns a counter which is incremented whenever the screen or the state shown with it changes */
+	quint32 screenGeneration() const
 	{
-		m_screenUpdated = false;
+		return m_screenGeneration;
 	}
 
 	const QString& user() const
@@ -118,13 +150,25 @@ public:
 
 	void setDesignatedModeFeature( Feature::Uid designatedModeFeature );
 
+	/** \brief Called once the server confirmed to push changes of user and active features */
+	void setStateNotificationsSubscribed();
+
 	void sendFeatureMessage( const FeatureMessage& featureMessage );
 
+	/*!
+	 * \brief Assigns a request ID to given query and sends it unless an identical query is still pending
+	 * \return whether the query has been sent
+	 */
+	bool sendFeatureRequest( const FeatureMessage& request );
+
+	/** \brief Serializes given message once and sends the same encoded data to all given computers */
+	static void sendFeatureMessage( const FeatureMessage& featureMessage, const QVector<Pointer>& computerControlInterfaces );
+
 
 private slots:
-	void setScreenUpdateFlag()
+	void updateScreenGeneration()
 	{
-		m_screenUpdated = true;
+		++m_screenGeneration;
 	}
 
 	void updateState();
@@ -133,7 +177,27 @@ private slots:
 
 	void handleFeatureMessage( const FeatureMessage& message );
 
+	void finishFullResolutionScreenGrab();
+
 private:
+	enum {
+		FullResolutionScreenTimeout = 10000,
+		StatePollingInterval = 5000,
+		FeatureRequestTimeout = 15000
+	};
+
+	typedef QPair<Feature::Uid, qint32> FeatureRequestKey;
+
+	struct PendingFeatureRequest
+	{
+		quint32 requestId;
+		QElapsedTimer age;
+	};
+
+	void stopFullResolutionScreenGrab();
+	bool isExpectedFeatureReply( const FeatureMessage& message );
+	void subscribeStateNotifications();
+
 	Computer m_computer;
 
 	State m_state;
@@ -147,12 +211,25 @@ private:
 	VeyonCoreConnection* m_coreConnection;
 	BuiltinFeatures* m_builtinFeatures;
 
-	bool m_screenUpdated;
+	quint32 m_screenGeneration;
+	bool m_updatesPaused;
+	bool m_focused;
+
+	// fallback for servers not supporting state notifications
+	QTimer* m_statePollingTimer;
+
+	// temporary connection for grabbing the screen in full resolution
+	VeyonVncConnection* m_fullResolutionConnection;
+	QTimer* m_fullResolutionTimeoutTimer;
+
+	quint32 m_lastFeatureRequestId;
+	QHash<FeatureRequestKey, PendingFeatureRequest> m_pendingFeatureRequests;
 
 signals:
 	void featureMessageReceived( const FeatureMessage&, ComputerControlInterface::Pointer );
 	void userChanged();
 	void activeFeaturesChanged();
+	void fullResolutionScreenGrabbed( const QImage& screen );
 
 };
 
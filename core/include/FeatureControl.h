@@ -25,8 +25,12 @@
 #ifndef FEATURE_CONTROL_H
 #define FEATURE_CONTROL_H
 
+#include <QPointer>
+
 #include "SimpleFeatureProvider.h"
 
+class FeatureWorkerManager;
+
 class VEYON_CORE_EXPORT FeatureControl : public QObject, public SimpleFeatureProvider, public PluginInterface
 {
 	Q_OBJECT
@@ -36,6 +40,7 @@ public:
 	~FeatureControl() override;
 
 	bool queryActiveFeatures( const ComputerControlInterfaceList& computerControlInterfaces );
+	bool subscribeActiveFeatures( const ComputerControlInterfaceList& computerControlInterfaces );
 
 	Plugin::Uid uid() const override
 	{
@@ -77,22 +82,34 @@ public:
 
 	bool handleFeatureMessage( VeyonServerInterface& server, const FeatureMessage& message ) override;
 
+private slots:
+	void sendActiveFeaturesToSubscribers();
+
 private:
 	enum Commands
 	{
 		QueryActiveFeatures,
+		SubscribeActiveFeatures,
 	};
 
 	enum Arguments
 	{
 		ActiveFeatureList,
+		Subscribed,
 	};
 
+	void sendActiveFeatures( QIODevice* ioDevice, FeatureMessage::Command command,
+							 FeatureMessage::RequestId requestId,
+							 const FeatureUidList& activeFeatures, bool subscribed ) const;
+
 	const Feature m_featureControlFeature;
 	const FeatureList m_features;
 
 	FeatureUidList m_activeFeatures;
 
+	QPointer<FeatureWorkerManager> m_featureWorkerManager;
+	QList<QPointer<QIODevice> > m_subscribers;
+
 };
 
 #endif // FEATURE_CONTROL_H
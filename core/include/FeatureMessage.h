@@ -38,6 +38,7 @@ public:
 	typedef Feature::Uid FeatureUid;
 	typedef qint32 Command;
 	typedef QMap<QString, QVariant> Arguments;
+	typedef quint32 RequestId;
 
 	enum SpecialCommands
 	{
@@ -50,7 +51,8 @@ public:
 		m_ioDevice( ioDevice ),
 		m_featureUid(),
 		m_command( InvalidCommand ),
-		m_arguments()
+		m_arguments(),
+		m_requestId( 0 )
 	{
 	}
 
@@ -58,7 +60,8 @@ public:
 		m_ioDevice( nullptr ),
 		m_featureUid( featureUid ),
 		m_command( command ),
-		m_arguments()
+		m_arguments(),
+		m_requestId( 0 )
 	{
 	}
 
@@ -66,7 +69,8 @@ public:
 		m_ioDevice( other.ioDevice() ),
 		m_featureUid( other.featureUid() ),
 		m_command( other.command() ),
-		m_arguments( other.arguments() )
+		m_arguments( other.arguments() ),
+		m_requestId( other.requestId() )
 	{
 	}
 
@@ -78,6 +82,7 @@ public:
 		m_featureUid = other.featureUid();
 		m_command = other.command();
 		m_arguments = other.arguments();
+		m_requestId = other.requestId();
 
 		return *this;
 	}
@@ -113,6 +118,23 @@ public:
 		return m_arguments.contains( QString::number( index ) );
 	}
 
+	/*!
+	 * \brief Returns ID for correlating replies with requests
+	 *
+	 * Replies carry the ID of the request they answer. Messages sent unsolicitedly (e.g. notifications
+	 * to subscribers) as well as messages from peers not supporting request IDs have an ID of 0.
+	 */
+	RequestId requestId() const
+	{
+		return m_requestId;
+	}
+
+	FeatureMessage& setRequestId( RequestId requestId )
+	{
+		m_requestId = requestId;
+		return *this;
+	}
+
 	bool send();
 	bool send( QIODevice* ioDevice ) const;
 
@@ -131,6 +153,7 @@ private:
 	FeatureUid m_featureUid;
 	Command m_command;
 	Arguments m_arguments;
+	RequestId m_requestId;
 
 } ;
 
@@ -94,9 +94,22 @@ protected:
 	bool sendFeatureMessage( const FeatureMessage& message,
 							 const ComputerControlInterfaceList& computerControlInterfaces )
 	{
-		for( auto controlInterface : computerControlInterfaces )
+		ComputerControlInterface::sendFeatureMessage( message, computerControlInterfaces );
+
+		return true;
+	}
+
+	/*!
+	 * \brief Sends a query which expects a reply with a request ID of its own to each computer
+	 *
+	 * Queries identical to one still waiting for a reply are not sent again.
+	 */
+	bool sendFeatureRequest( const FeatureMessage& request,
+							 const ComputerControlInterfaceList& computerControlInterfaces )
+	{
+		for( const auto& controlInterface : computerControlInterfaces )
 		{
-			controlInterface->sendFeatureMessage( message );
+			controlInterface->sendFeatureRequest( request );
 		}
 
 		return true;
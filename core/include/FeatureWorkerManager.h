@@ -64,6 +64,9 @@ private slots:
 
 	void sendPendingMessages();
 
+signals:
+	void runningWorkersChanged();
+
 private:
 	VeyonServerInterface& m_server;
 	FeatureManager& m_featureManager;
@@ -0,0 +1,97 @@
+/*
+ * FramebufferActivityDetector.h - declaration of FramebufferActivityDetector class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef FRAMEBUFFER_ACTIVITY_DETECTOR_H
+#define FRAMEBUFFER_ACTIVITY_DETECTOR_H
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QMutex>
+#include <QRegion>
+#include <QVector>
+
+#include "VeyonCore.h"
+
+/*!
+ * \brief Measures how much of a 32 bit framebuffer changes over time
+ *
+ * The framebuffer is divided into blocks of which a hash is kept. After each framebuffer update
+ * only the blocks covered by the damaged region are hashed again (vectorized using SSE2 or AVX2 on
+ * x86 and NEON on ARM) and compared with their previous hash. Areas which are sent again without
+ * actually changing therefore are not counted. The fraction of changed pixels is accumulated with
+ * exponential decay, resulting in the average fraction of the screen changed per second.
+ *
+ * update() and reset() have to be called from the thread updating the framebuffer while
+ * activity() and isIdle() can be called from any thread.
+ */
+class VEYON_CORE_EXPORT FramebufferActivityDetector
+{
+public:
+	enum {
+		BlockSize = 16,
+		TimeConstant = 5000,
+		IdleActivity = 2,
+		HighActivity = 100,
+	};
+
+	FramebufferActivityDetector();
+
+	void reset();
+
+	/*!
+	 * \brief Compares the blocks of \a image covered by \a damage with their previous content
+	 */
+	void update( const QImage& image, const QRegion& damage );
+
+	/*!
+	 * \brief Returns the average fraction of the screen changed per second in permille
+	 */
+	int activity() const;
+
+	/*!
+	 * \brief Returns whether the screen hardly changed during the last measurement period
+	 */
+	bool isIdle() const;
+
+private:
+	void hashAll( const QImage& image );
+	int hashBlock( const QImage& image, int blockIndex );
+	void recordChange( double changedFraction );
+	double decayedActivity( qint64 now ) const;
+	int activityLevel( qint64 now ) const;
+
+	QSize m_size;
+	int m_columns;
+	QVector<quint64> m_blockHashes;
+	QVector<bool> m_damagedBlocks;
+	QVector<int> m_blockQueue;
+
+	mutable QMutex m_mutex;
+	QElapsedTimer m_clock;
+	qint64 m_lastChange;
+	double m_activity;
+
+} ;
+
+#endif
@@ -0,0 +1,91 @@
+/*
+ * FramebufferPool.h - declaration of FramebufferPool class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef FRAMEBUFFER_POOL_H
+#define FRAMEBUFFER_POOL_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QMap>
+#include <QMutex>
+#include <QVector>
+
+#include "VeyonCore.h"
+
+/*!
+ * \brief Process-wide pool for framebuffer memory
+ *
+ * Requested sizes are rounded up to size classes (four classes per power of two) so buffers of
+ * reconnecting hosts or of connections switching quality levels can be reused instead of
+ * fragmenting the heap. Large buffers are aligned to 2 MB boundaries and marked for transparent
+ * huge pages on Linux. Released buffers are kept up to a fixed total size.
+ *
+ * The pool is a function-local static so buffers still referenced by QImage copies can be released
+ * safely during shutdown. All methods are thread-safe.
+ */
+class VEYON_CORE_EXPORT FramebufferPool
+{
+public:
+	enum {
+		MinimumSizeClass = 64 * 1024,
+		SmallBufferAlignment = 64,
+		HugePageSize = 2 * 1024 * 1024,
+		MaximumPooledSize = 256 * 1024 * 1024,
+	};
+
+	struct Statistics
+	{
+		quint64 allocationCount;
+		quint64 reuseCount;
+		qint64 bytesInUse;
+		qint64 bytesPooled;
+	};
+
+	static FramebufferPool& instance();
+
+	/*!
+	 * \brief Returns a buffer of at least \a size bytes - contents are undefined
+	 */
+	void* allocate( size_t size );
+	void release( void* buffer );
+
+	Statistics statistics() const;
+	QJsonObject statisticsToJson() const;
+
+private:
+	FramebufferPool();
+	~FramebufferPool();
+
+	static size_t sizeClass( size_t size );
+	static void* allocateAligned( size_t size );
+	static void freeAligned( void* buffer, size_t size );
+
+	mutable QMutex m_mutex;
+	QMap<size_t, QVector<void *> > m_freeBuffers;
+	QHash<void *, size_t> m_usedBuffers;
+	Statistics m_statistics;
+
+} ;
+
+#endif
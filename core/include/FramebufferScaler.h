@@ -0,0 +1,83 @@
+/*
+ * FramebufferScaler.h - declaration of FramebufferScaler class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef FRAMEBUFFER_SCALER_H
+#define FRAMEBUFFER_SCALER_H
+
+#include <QImage>
+
+#include "VeyonCore.h"
+
+/*!
+ * \brief Fast area-averaging (box filter) downscaler for 32 bit framebuffers
+ *
+ * Each target pixel is the average of the source pixels it covers. Vertical accumulation is
+ * vectorized using SSE2 or AVX2 (selected at runtime) on x86 and NEON on ARM. Since every target
+ * pixel only depends on its own source area, arbitrary parts of the target image can be updated
+ * with results identical to scaling the whole image.
+ */
+class VEYON_CORE_EXPORT FramebufferScaler
+{
+public:
+	enum Kernel
+	{
+		GenericKernel,
+		Sse2Kernel,
+		Avx2Kernel,
+		NeonKernel,
+		KernelCount
+	} ;
+
+	static bool canScale( const QImage& source, QSize targetSize );
+
+	/*!
+	 * \brief Returns a scaled copy of \a source, falls back to QImage::scaled() if \a source can't be downscaled
+	 */
+	static QImage scaled( const QImage& source, QSize targetSize );
+
+	/*!
+	 * \brief Updates \a targetArea of \a target with the corresponding scaled area of \a source
+	 * \return false if \a source can't be downscaled to the size of \a target
+	 */
+	static bool scale( const QImage& source, QImage& target, const QRect& targetArea );
+
+	/*!
+	 * \brief Returns the area of a target image with given size which depends on \a sourceArea
+	 */
+	static QRect mapToTarget( const QRect& sourceArea, QSize sourceSize, QSize targetSize );
+
+	/** \brief Returns whether given kernel has been compiled in and is supported by the CPU */
+	static bool isKernelSupported( Kernel kernel );
+
+	/*!
+	 * \brief Forces given kernel for the vertical pass instead of the one selected at runtime
+	 *
+	 * Intended for tests and benchmarks only. Must not be called while images are being scaled.
+	 */
+	static bool setKernel( Kernel kernel );
+	static void resetKernel();
+
+} ;
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * HostProber.h - declaration of HostProber class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef HOST_PROBER_H
+#define HOST_PROBER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include "VeyonCore.h"
+
+/*!
+ * \brief Checks whether hosts are reachable without spawning external processes
+ *
+ * On Linux, ICMP echo requests are sent through a single unprivileged ICMP datagram socket
+ * shared by all threads. Whichever waiting thread comes first receives the replies for all
+ * pending probes. Concurrent probes of the same address are merged. If ICMP sockets are not
+ * available (e.g. restricted by net.ipv4.ping_group_range or on other platforms) a TCP connection
+ * attempt is made instead where a refused connection also indicates a reachable host.
+ *
+ * Results are cached per host for a short time. All methods are thread-safe and may block
+ * for up to one probe timeout so they must not be called from the GUI thread.
+ */
+class VEYON_CORE_EXPORT HostProber
+{
+public:
+	enum {
+		IcmpProbeTimeout = 1000,
+		TcpProbeTimeout = 2000,
+		ReceiveInterval = 100,
+		CacheLifetime = 5000,
+	};
+
+	HostProber();
+	~HostProber();
+
+	bool isReachable( const QString& host, int port );
+
+private:
+	enum ProbeResult {
+		ProbeFailed,
+		HostUnreachable,
+		HostReachable
+	};
+
+	struct Probe
+	{
+		quint16 sequence;
+		bool finished;
+		int waiterCount;
+	};
+
+	struct CacheEntry
+	{
+		bool reachable;
+		QElapsedTimer age;
+	};
+
+	static QHostAddress resolve( const QString& host );
+
+	ProbeResult probeIcmp( const QHostAddress& address );
+	ProbeResult probeTcp( const QHostAddress& address, int port );
+
+	bool sendEchoRequest( quint32 address, quint16 sequence );
+	void receiveEchoReplies( int timeout );
+
+	QMutex m_mutex;
+	QWaitCondition m_probesUpdated;
+	QHash<QString, CacheEntry> m_cache;
+	QHash<quint32, Probe *> m_pendingProbes;
+	int m_icmpSocket;
+	quint16 m_icmpSequence;
+	bool m_receiving;
+
+} ;
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * HostResolver.h - declaration of HostResolver class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef HOST_RESOLVER_H
+#define HOST_RESOLVER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
+#include <QMutex>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include "VeyonCore.h"
+
+/*!
+ * \brief Process-wide cache for host name lookups
+ *
+ * Lookups run in a small thread pool of their own so callers never wait for slow name servers
+ * unless they explicitly ask to. Concurrent lookups of the same host name are merged. Successful
+ * results are cached for several minutes, failures for a few seconds only so hosts which have just
+ * been added to the DNS are found soon. Expired successful results are still returned while the
+ * entry is refreshed in background.
+ *
+ * All methods are thread-safe. Only resolve() may block and thus must not be called from the GUI thread.
+ */
+class VEYON_CORE_EXPORT HostResolver
+{
+public:
+	typedef QList<QHostAddress> AddressList;
+
+	enum {
+		PositiveLifetime = 300000,
+		NegativeLifetime = 10000,
+		LookupTimeout = 5000,
+		MaximumConcurrentLookups = 4,
+	};
+
+	HostResolver();
+	~HostResolver();
+
+	/*!
+	 * \brief Returns cached addresses of given host without blocking
+	 * \return false if no result is available yet, a lookup has been started in this case
+	 */
+	bool lookup( const QString& host, AddressList& addresses );
+
+	/** \brief Returns addresses of given host, waits up to \a timeout ms for a lookup to finish */
+	AddressList resolve( const QString& host, int timeout = LookupTimeout );
+
+	/** \brief Starts lookups of all given hosts which are not cached yet */
+	void prefetch( const QStringList& hosts );
+
+	/** \brief Returns the first IPv4 address if any as libvncclient and ICMP probes handle these best */
+	static QHostAddress preferredAddress( const AddressList& addresses );
+
+private:
+	struct CacheEntry
+	{
+		AddressList addresses;
+		QElapsedTimer age;
+		bool pending;
+	};
+
+	bool isExpired( const CacheEntry& entry ) const;
+	void startLookup( const QString& host );
+	void finishLookup( const QString& host, const AddressList& addresses );
+
+	QMutex m_mutex;
+	QWaitCondition m_lookupFinished;
+	QHash<QString, CacheEntry> m_cache;
+	QThreadPool m_threadPool;
+
+} ;
+
+#endif
@@ -25,7 +25,8 @@
 #ifndef NETWORK_OBJECT_DIRECTORY_H
 #define NETWORK_OBJECT_DIRECTORY_H
 
-#include <QObject>
+#include <QFutureWatcher>
+#include <QHash>
 
 #include "NetworkObject.h"
 
@@ -35,6 +36,8 @@ class VEYON_CORE_EXPORT NetworkObjectDirectory : public QObject
 {
 	Q_OBJECT
 public:
+	typedef QHash<NetworkObject, QList<NetworkObject>> ObjectMap;
+
 	enum {
 		MinimumUpdateInterval = 10,
 		DefaultUpdateInterval = 60,
@@ -42,19 +45,32 @@ public:
 	};
 
 	NetworkObjectDirectory( QObject* parent );
+	~NetworkObjectDirectory() override;
 
 	void setUpdateInterval( int interval );
 
-	virtual QList<NetworkObject> objects( const NetworkObject& parent ) = 0;
+	QList<NetworkObject> objects( const NetworkObject& parent ) const;
+
+	/*! \brief Queries all groups and their members from the backend. This is called from worker threads and
+	 * therefore must neither access the current objects nor any other state shared with the main thread. */
+	virtual ObjectMap fetchObjects() = 0;
+
+	/*! \brief Replaces the current objects and emits the change signals for all differences */
+	void setObjects( const ObjectMap& objects );
 
 	virtual QList<NetworkObject> queryObjects( NetworkObject::Type type, const QString& name = QString() ) = 0;
 	virtual NetworkObject queryParent( const NetworkObject& object ) = 0;
 
 public slots:
-	virtual void update() = 0;
+	void update();
+	void updateInBackground();
 
 private:
+	void updateGroup( const NetworkObject& groupObject, const QList<NetworkObject>& members );
+
 	QTimer* m_updateTimer;
+	QFutureWatcher<ObjectMap> m_fetchWatcher;
+	ObjectMap m_objects;
 
 signals:
 	void objectsAboutToBeInserted( const NetworkObject& parent, int index, int count );
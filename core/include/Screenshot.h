@@ -38,6 +38,7 @@ class VEYON_CORE_EXPORT Screenshot : public QObject
 public:
 	Screenshot( const QString &fileName = QString(), QObject* parent = nullptr );
 
+	/** \brief Grabs the screen of given computer and saves it with a caption, emits finished() when done */
 	void take( ComputerControlInterface::Pointer computerControlInterface );
 
 	bool isValid() const
@@ -65,9 +66,15 @@ public:
 	QString date() const;
 	QString time() const;
 
+signals:
+	void finished();
+
+private slots:
+	void save( const QImage& screen );
 
 private:
 	QString m_fileName;
+	QString m_caption;
 	QImage m_image;
 
 } ;
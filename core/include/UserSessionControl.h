@@ -27,6 +27,8 @@
 
 #include <QReadWriteLock>
 
+#include <QPointer>
+
 #include "SimpleFeatureProvider.h"
 
 class QThread;
@@ -41,6 +43,7 @@ public:
 	~UserSessionControl() override;
 
 	bool getUserSessionInfo( const ComputerControlInterfaceList& computerControlInterfaces );
+	bool subscribeUserSessionInfo( const ComputerControlInterfaceList& computerControlInterfaces );
 
 	Plugin::Uid uid() const override
 	{
@@ -85,19 +88,31 @@ public:
 
 	bool handleFeatureMessage( VeyonServerInterface& server, const FeatureMessage& message ) override;
 
+private slots:
+	void sendUserSessionInfoToSubscribers();
+
 private:
 	enum Commands
 	{
 		GetInfo,
 		LogonUser,
-		LogoutUser
+		LogoutUser,
+		SubscribeInfo
 	};
 
 	enum Arguments
 	{
 		UserName,
+		Subscribed,
 	};
 
+	enum {
+		UserSessionMonitorInterval = 2000
+	};
+
+	void sendUserSessionInfo( QIODevice* ioDevice, FeatureMessage::Command command,
+							  FeatureMessage::RequestId requestId, bool subscribed );
+	void monitorUserSession();
 	void queryUserInformation();
 	bool confirmFeatureExecution( const Feature& feature, QWidget* parent );
 
@@ -107,6 +122,9 @@ private:
 
 	QThread* m_userInfoQueryThread;
 	QTimer* m_userInfoQueryTimer;
+	QTimer* m_userSessionMonitorTimer;
+
+	QList<QPointer<QIODevice> > m_subscribers;
 
 	QReadWriteLock m_userDataLock;
 	QString m_userName;
@@ -49,6 +49,12 @@ public:
 
 	VariantArrayMessage& write( const QVariant& v );
 
+	/** \brief Returns whether all values of a received message have been read */
+	bool atEnd() const
+	{
+		return m_buffer.atEnd();
+	}
+
 	QIODevice* ioDevice() const
 	{
 		return m_ioDevice;
@@ -97,6 +97,13 @@ public slots:
 	void setEnforceSelectedModeForClients( bool );
 	void setOpenComputerManagementAtStart( bool );
 	void setConfirmDangerousActions( bool );
+	void setMaximumConcurrentConnectionAttempts( int );
+	void setConnectionAttemptsPerSecond( int );
+	void setMaximumReconnectInterval( int );
+	void setMaximumIngressBandwidth( int );
+	void setAdaptiveConnectionQualityEnabled( bool );
+	void setThumbnailCacheEnabled( bool );
+	void setConnectionStatisticsEnabled( bool );
 	void setAuthenticationMethod( int );
 	void setPrivateKeyBaseDir( const QString & );
 	void setPublicKeyBaseDir( const QString & );
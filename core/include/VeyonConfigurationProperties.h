@@ -92,6 +92,13 @@
 	OP( VeyonConfiguration, VeyonCore::config(), BOOL, enforceSelectedModeForClients, setEnforceSelectedModeForClients, "EnforceSelectedModeForClients", "Master" );	\
 	OP( VeyonConfiguration, VeyonCore::config(), BOOL, openComputerManagementAtStart, setOpenComputerManagementAtStart, "OpenComputerManagementAtStart", "Master" );	\
 	OP( VeyonConfiguration, VeyonCore::config(), BOOL, confirmDangerousActions, setConfirmDangerousActions, "ConfirmDangerousActions", "Master" );	\
+	OP( VeyonConfiguration, VeyonCore::config(), INT, maximumConcurrentConnectionAttempts, setMaximumConcurrentConnectionAttempts, "MaximumConcurrentConnectionAttempts", "Master" );	\
+	OP( VeyonConfiguration, VeyonCore::config(), INT, connectionAttemptsPerSecond, setConnectionAttemptsPerSecond, "ConnectionAttemptsPerSecond", "Master" );	\
+	OP( VeyonConfiguration, VeyonCore::config(), INT, maximumReconnectInterval, setMaximumReconnectInterval, "MaximumReconnectInterval", "Master" );	\
+	OP( VeyonConfiguration, VeyonCore::config(), INT, maximumIngressBandwidth, setMaximumIngressBandwidth, "MaximumIngressBandwidth", "Master" );	\
+	OP( VeyonConfiguration, VeyonCore::config(), BOOL, adaptiveConnectionQualityEnabled, setAdaptiveConnectionQualityEnabled, "AdaptiveConnectionQualityEnabled", "Master" );	\
+	OP( VeyonConfiguration, VeyonCore::config(), BOOL, thumbnailCacheEnabled, setThumbnailCacheEnabled, "ThumbnailCacheEnabled", "Master" );	\
+	OP( VeyonConfiguration, VeyonCore::config(), BOOL, connectionStatisticsEnabled, setConnectionStatisticsEnabled, "ConnectionStatisticsEnabled", "Master" );	\
 
 #define FOREACH_VEYON_AUTHENTICATION_CONFIG_PROPERTY(OP) \
 	OP( VeyonConfiguration, VeyonCore::config(), INT, authenticationMethod, setAuthenticationMethod, "Method", "Authentication" );	\
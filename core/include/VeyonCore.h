@@ -46,6 +46,8 @@ class AuthenticationCredentials;
 class ComputerControlInterface;
 class CryptoCore;
 class Filesystem;
+class HostProber;
+class HostResolver;
 class Logger;
 class NetworkObjectDirectoryManager;
 class PlatformPluginInterface;
@@ -53,6 +55,7 @@ class PlatformPluginManager;
 class PluginManager;
 class UserGroupsBackendManager;
 class VeyonConfiguration;
+class VncConnectionEngine;
 
 // clazy:excludeall=ctor-missing-parent-argument
 
@@ -109,6 +112,21 @@ public:
 		return *( instance()->m_networkObjectDirectoryManager );
 	}
 
+	static VncConnectionEngine& vncConnectionEngine()
+	{
+		return *( instance()->m_vncConnectionEngine );
+	}
+
+	static HostProber& hostProber()
+	{
+		return *( instance()->m_hostProber );
+	}
+
+	static HostResolver& hostResolver()
+	{
+		return *( instance()->m_hostResolver );
+	}
+
 	static Filesystem& filesystem()
 	{
 		return *( instance()->m_filesystem );
@@ -168,6 +186,9 @@ private:
 	PlatformPluginInterface* m_platformPlugin;
 	UserGroupsBackendManager* m_userGroupsBackendManager;
 	NetworkObjectDirectoryManager* m_networkObjectDirectoryManager;
+	VncConnectionEngine* m_vncConnectionEngine;
+	HostProber* m_hostProber;
+	HostResolver* m_hostResolver;
 
 	ComputerControlInterface* m_localComputerControlInterface;
 
@@ -69,6 +69,11 @@ public:
 
 	void sendFeatureMessage( const FeatureMessage &featureMessage );
 
+	/** \brief Sends a message previously encoded by encodeFeatureMessage() without serializing it again */
+	void sendEncodedFeatureMessage( const QByteArray& encodedMessage );
+
+	static QByteArray encodeFeatureMessage( const FeatureMessage& featureMessage );
+
 signals:
 	void featureMessageReceived( const FeatureMessage& );
 
@@ -26,11 +26,37 @@
 #ifndef VEYON_RFB_EXT_H
 #define VEYON_RFB_EXT_H
 
+#include <stdint.h>
+
 typedef struct _rfbClient rfbClient;
 
 // new rfb command which tells server or client that a Veyon feature message is following
 #define rfbVeyonFeatureMessage		41
 
+// pseudo encoding announcing that the client supports server-side scaled framebuffers
+#define rfbEncodingVeyonScaledFramebuffer	0x56455931
+
+// server to client: acknowledges support for scaled framebuffers
+// client to server: sets size of scaled framebuffer (0x0 disables scaling)
+#define rfbVeyonScaledFramebuffer	42
+
+typedef struct {
+	uint8_t type;
+	uint8_t pad1;
+	uint16_t pad2;
+} rfbVeyonScaledFramebufferAckMsg;
+
+#define sz_rfbVeyonScaledFramebufferAckMsg 4
+
+typedef struct {
+	uint8_t type;
+	uint8_t pad;
+	uint16_t width;
+	uint16_t height;
+} rfbVeyonSetScaledSizeMsg;
+
+#define sz_rfbVeyonSetScaledSizeMsg 6
+
 
 #define rfbSecTypeVeyon 40
 
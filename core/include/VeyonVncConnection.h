@@ -28,18 +28,25 @@
 #ifndef VEYON_VNC_CONNECTION_H
 #define VEYON_VNC_CONNECTION_H
 
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QElapsedTimer>
+#include <QFuture>
 #include <QMutex>
 #include <QQueue>
 #include <QReadWriteLock>
-#include <QThread>
-#include <QTimer>
-#include <QWaitCondition>
 #include <QImage>
+#include <QRegion>
 
 #include "rfb/rfbproto.h"
 
+#include "FramebufferActivityDetector.h"
 #include "RfbVeyonAuth.h"
 #include "SocketDevice.h"
+#include "VncBandwidthScheduler.h"
+#include "VncConnectionStatistics.h"
+#include "VncInputQueue.h"
+#include "VncQualityController.h"
 
 class MessageEvent	// clazy:exclude=copyable-polymorphic
 {
@@ -50,7 +57,9 @@ public:
 } ;
 
 
-class VEYON_CORE_EXPORT VeyonVncConnection : public QThread
+class VncConnectionEngineThread;
+
+class VEYON_CORE_EXPORT VeyonVncConnection : public QObject
 {
 	Q_OBJECT
 public:
@@ -87,8 +96,8 @@ public:
 	~VeyonVncConnection() override;
 
 	QImage image() const;
+	void start();
 	void stop( bool deleteAfterFinished = false );
-	void reset( const QString &host );
 	void setHost( const QString &host );
 	void setPort( int port );
 
@@ -97,6 +106,11 @@ public:
 		return m_state;
 	}
 
+	bool isRunning() const
+	{
+		return m_running.loadAcquire() != 0;
+	}
+
 	bool isConnected() const
 	{
 		return state() == Connected && isRunning();
@@ -129,6 +143,9 @@ public:
 
 	void enqueueEvent( MessageEvent *e );
 
+	/** \brief Retries to connect immediately and restarts the reconnect backoff, e.g. after the host has been woken up */
+	void resetReconnectBackoff();
+
 	const rfbClient *getRfbClient() const
 	{
 		return m_cl;
@@ -150,24 +167,53 @@ public:
 		return m_framebufferState == FramebufferValid;
 	}
 
-	void setScaledSize( QSize s )
+	void setScaledSize( QSize s );
+
+	/** \brief Returns the most recent scaled screen, scaling itself is done in background */
+	QImage scaledScreen() const;
+
+	/** \brief Returns whether the server sends a framebuffer already downscaled to the scaled size */
+	bool isFramebufferScaledByServer() const;
+	static void sendScaledSize( rfbClient* client, QSize size );
+
+	void setFramebufferUpdateInterval( int interval );
+
+	/** \brief Stops requesting framebuffer updates (e.g. while not visible) but keeps the connection open */
+	void setFramebufferUpdatesPaused( bool paused );
+
+	bool areFramebufferUpdatesPaused() const
+	{
+		return m_framebufferUpdatesPaused.loadAcquire();
+	}
+
+	/** \brief Marks the connection of the computer the user currently focuses for preferred bandwidth allocation */
+	void setFocused( bool focused )
 	{
-		if( m_scaledSize != s )
-		{
-			m_scaledSize = s;
-			m_scaledScreenNeedsUpdate = true;
-		}
+		m_focused.storeRelease( focused ? 1 : 0 );
 	}
 
-	QImage scaledScreen()
+	const VncConnectionStatistics& statistics() const
 	{
-		rescaleScreen();
-		return m_scaledScreen;
+		return m_statistics;
 	}
 
-	void setFramebufferUpdateInterval( int interval );
+	/** \brief Returns the time in ms it took to establish the most recent connection */
+	int connectLatency() const
+	{
+		return m_connectLatency.loadAcquire();
+	}
 
-	void rescaleScreen();
+	/** \brief Returns how far the encoding settings have been degraded due to a constrained link */
+	int qualityStep() const
+	{
+		return m_qualityController.step();
+	}
+
+	/** \brief Returns the average fraction of the screen changed per second in permille */
+	int screenActivity() const
+	{
+		return m_activityDetector.activity();
+	}
 
 	// authentication
 	static void handleSecTypeVeyon( rfbClient* client );
@@ -194,28 +240,52 @@ signals:
 	void passwordRequest();
 	void outputErrorMessage( const QString &message );
 	void stateChanged();
+	void scaledScreenUpdated();
+	void finished();
 
 
 public slots:
+	// input events have to be sent from the same thread, usually the GUI thread
 	void mouseEvent( int x, int y, int buttonMask );
 	void keyEvent( unsigned int key, bool pressed );
 	void clientCut( const QString &text );
 
 
-protected:
-	void run() override;
-
-
 private:
+	friend class VncConnectionEngine;
+	friend class VncConnectionEngineThread;
+
 	enum {
 		InitialFrameBufferTimeout = 15000,	/**< A server has to send an initial framebuffer within given timeout in ms */
-		ThreadTerminationTimeout = 10000,
 		MessageWaitTimeout = 500,
+		DefaultReconnectInterval = 1000,
+		MaximumDamagedRectCount = 64,
+		PausedUpdateInterval = 5000,
+		ThumbnailTransferTime = 100,
+		RemoteControlTransferTime = 40,
+		DefaultTransferTime = 200,
+		IdleUpdateIntervalFactor = 2,
 	};
 
-	void establishConnection();
-	void handleConnection();
+	// called by VncConnectionEngine
+	bool establishConnection();
+	bool handleServerMessages();
+	int handleUpdateTimer();
 	void closeConnection();
+	void finishEngineProcessing();
+
+	int socketDescriptor() const;
+	int reconnectInterval() const;
+	bool isReconnectDue();
+	bool isUpdateRequestDue();
+
+	bool isStopRequested() const
+	{
+		return m_stopRequested.loadAcquire() != 0;
+	}
+
+	void requestFramebufferUpdate();
+	QString currentEncoding() const;
 
 	void setState( State state );
 
@@ -223,6 +293,24 @@ private:
 
 	void sendEvents();
 
+	QSize scaledSize();
+	static int thumbnailQualityLevel( QSize scaledSize );
+	static int thumbnailCompressLevel( QSize scaledSize );
+	static int thumbnailUpdateInterval( int updateInterval, QSize scaledSize );
+
+	VncQualityController::Bounds qualityBounds();
+	int baseUpdateInterval();
+	void applyQualitySettings( rfbClient* client ) const;
+	void lockExtensionEncodings() const;
+	static void unlockExtensionEncodings();
+	int updateInterval() const;
+	VncBandwidthScheduler::Priority bandwidthPriority() const;
+
+	void updateScaledScreen();
+	void rescaleScreen();
+	static bool isFullRescaleRequired( const QRegion& damage, QSize sourceSize );
+	void rescaleDamagedRegion( const QImage& source, const QRegion& damage );
+
 	// hooks for LibVNCClient
 	static int8_t hookInitFrameBuffer( rfbClient* client );
 	static void hookUpdateFB( rfbClient* client, int x, int y, int w, int h );
@@ -241,20 +329,52 @@ private:
 	QualityLevels m_quality;
 	QString m_host;
 	int m_port;
-	QTimer m_terminateTimer;
-	QWaitCondition m_updateIntervalSleeper;
 	int m_framebufferUpdateInterval;
+	QElapsedTimer m_framebufferInitTimer;
+	QAtomicInt m_serverScalingSupported;
+	QAtomicInt m_updateRequestDue;
+	QAtomicInt m_framebufferUpdatesPaused;
+	QAtomicInt m_focused;
+	QAtomicInt m_connectLatency;
+	QAtomicInt m_failedConnectionAttempts;
+	QAtomicInt m_reconnectDue;
+	QAtomicInt m_qualityBoundsChanged;
+
+	VncConnectionStatistics m_statistics;
+	QElapsedTimer m_messageTimer;
+	QElapsedTimer m_updateRequestTimer;
+	qint64 m_bytesReceived;
+	qint64 m_decodedUpdateBytes;
+	VncQualityController m_qualityController;
+	QRegion m_activityDamage;
+	FramebufferActivityDetector m_activityDetector;
 	QMutex m_mutex;
 	mutable QReadWriteLock m_imgLock;
 	QQueue<MessageEvent *> m_eventQueue;
+	VncInputQueue m_inputQueue;
+	QVector<VncInputQueue::Event> m_inputEvents;
 
 	QImage m_image;
+
+	// scaled screen is updated in background and published to m_scaledScreen afterwards
+	QMutex m_scaledScreenUpdateLock;
 	bool m_scaledScreenNeedsUpdate;
-	QImage m_scaledScreen;
+	bool m_scaledScreenUpdateRunning;
+	QFuture<void> m_scaledScreenUpdate;
+	QElapsedTimer m_scaledScreenUpdateTimer;
 	QSize m_scaledSize;
+	QRegion m_scaledScreenDamage;
+	QImage m_scaledScreenBackBuffer;
+	QSize m_scaledScreenSourceSize;
+	mutable QReadWriteLock m_scaledScreenLock;
+	QImage m_scaledScreen;
 
 	volatile State m_state;
 
+	QAtomicInt m_running;
+	QAtomicInt m_stopRequested;
+	QAtomicPointer<VncConnectionEngineThread> m_engineThread;
+
 
 } ;
 
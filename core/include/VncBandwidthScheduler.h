@@ -0,0 +1,107 @@
+/*
+ * VncBandwidthScheduler.h - declaration of VncBandwidthScheduler class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef VNC_BANDWIDTH_SCHEDULER_H
+#define VNC_BANDWIDTH_SCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+
+#include "VeyonCore.h"
+
+class VeyonVncConnection;
+
+/*!
+ * \brief Shares the configured ingress bandwidth between all VNC connections of a process
+ *
+ * Scheduling follows deficit round robin, an approximation of weighted fair queuing. On every
+ * tick the byte budget is distributed among all recently active connections according to the weight
+ * of their priority. A connection may only request its next framebuffer update while its deficit
+ * counter is positive. Received updates are charged afterwards. Weights differ by a factor of four
+ * between priorities so higher priorities are served almost exclusively while the link is saturated.
+ *
+ * All methods are thread-safe. Without a configured bandwidth all requests are admitted immediately.
+ */
+class VEYON_CORE_EXPORT VncBandwidthScheduler
+{
+public:
+	enum Priority
+	{
+		BackgroundPriority,
+		VisiblePriority,
+		FocusedPriority,
+		RemoteControlPriority,
+		PriorityCount
+	} ;
+
+	enum {
+		TickInterval = 20,
+		ActiveFlowTimeout = 2000,
+		BurstTickCount = 10,
+		MinimumBurst = 16 * 1024,
+		MaximumRetryDelay = 1000,
+	};
+
+	VncBandwidthScheduler();
+
+	/** \brief Sets the total ingress bandwidth in bytes per second, 0 disables scheduling */
+	void setBandwidth( qint64 bytesPerSecond );
+
+	/*!
+	 * \brief Asks for permission to request a framebuffer update
+	 * \return 0 if the update can be requested, otherwise time in ms after which to ask again
+	 */
+	int admitUpdateRequest( VeyonVncConnection* connection, Priority priority );
+
+	/** \brief Charges the bytes received for an update to the connection's budget */
+	void chargeUpdate( VeyonVncConnection* connection, qint64 bytes );
+
+	void removeConnection( VeyonVncConnection* connection );
+
+private:
+	struct Flow
+	{
+		Priority priority;
+		qint64 deficit;
+		qint64 lastActivity;
+	};
+
+	static int weight( Priority priority )
+	{
+		return 1 << ( 2 * priority );
+	}
+
+	void refill( qint64 now );
+	int activeWeight( qint64 now ) const;
+
+	QMutex m_mutex;
+	qint64 m_bytesPerSecond;
+	QElapsedTimer m_clock;
+	qint64 m_lastRefill;
+	QHash<VeyonVncConnection *, Flow> m_flows;
+
+} ;
+
+#endif
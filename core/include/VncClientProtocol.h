@@ -119,6 +119,9 @@ private:
 									uint bytesPerPixel );
 	bool handleRectEncodingZlib( QBuffer& buffer );
 	bool handleRectEncodingZRLE( QBuffer& buffer );
+	bool handleRectEncodingTight( QBuffer& buffer, const rfbFramebufferUpdateRectHeader rectHeader );
+
+	static bool readTightCompactLength( QBuffer& buffer, uint32_t& length );
 
 	static bool isPseudoEncoding( rfbFramebufferUpdateRectHeader header );
 
@@ -0,0 +1,110 @@
+/*
+ * VncConnectionEngine.h - declaration of VncConnectionEngine class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef VNC_CONNECTION_ENGINE_H
+#define VNC_CONNECTION_ENGINE_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QSet>
+#include <QThreadPool>
+#include <QVector>
+
+#include "VeyonCore.h"
+#include "VncBandwidthScheduler.h"
+
+class VeyonVncConnection;
+class VncConnectionEngineThread;
+
+/*!
+ * \brief The VncConnectionEngine class drives all VeyonVncConnection instances of a process
+ *
+ * Instead of running one thread per connection, the sockets of all connections are multiplexed
+ * by a small fixed number of I/O threads (using epoll on Linux). Each connection is handled as a
+ * state machine by the I/O thread it has been assigned to. The blocking RFB handshake is carried out
+ * by a separate thread pool so that unreachable hosts do not stall the I/O threads.
+ *
+ * To avoid connection storms (e.g. at program start or when selecting a large room) handshakes
+ * are admitted by a token bucket with a limited number of concurrent handshakes. Connections
+ * with paused framebuffer updates (i.e. invisible computers) only get admitted if no other
+ * connection is waiting.
+ *
+ * Framebuffer update requests of all connections are paced by a VncBandwidthScheduler so that
+ * a saturated link is shared according to the priority of each connection.
+ */
+class VEYON_CORE_EXPORT VncConnectionEngine : public QObject
+{
+	Q_OBJECT
+public:
+	explicit VncConnectionEngine( QObject* parent = nullptr );
+	~VncConnectionEngine() override;
+
+	void addConnection( VeyonVncConnection* connection );
+	void removeConnection( VeyonVncConnection* connection );
+	void wakeUp( VeyonVncConnection* connection );
+
+	QThreadPool& handshakeThreadPool()
+	{
+		return m_handshakeThreadPool;
+	}
+
+	/*!
+	 * \brief Asks for permission to start the handshake of given connection
+	 * \return 0 if handshake can be started, otherwise time in ms after which to ask again
+	 */
+	int admitHandshake( VeyonVncConnection* connection );
+	void finishHandshake();
+	void forgetConnection( VeyonVncConnection* connection );
+
+	VncBandwidthScheduler& bandwidthScheduler()
+	{
+		return m_bandwidthScheduler;
+	}
+
+private:
+	enum {
+		MaximumThreadCount = 4,
+		HandshakeThreadCount = 32,
+		AdmissionRetryInterval = 50,
+	};
+
+	void startThreads();
+
+	QMutex m_threadsLock;
+	QVector<VncConnectionEngineThread *> m_threads;
+	QThreadPool m_handshakeThreadPool;
+
+	QMutex m_admissionLock;
+	int m_maximumConcurrentHandshakes;
+	int m_handshakesPerSecond;
+	int m_activeHandshakes;
+	double m_handshakeTokens;
+	QElapsedTimer m_handshakeTokenClock;
+	QSet<VeyonVncConnection *> m_waitingPrioritizedConnections;
+
+	VncBandwidthScheduler m_bandwidthScheduler;
+
+} ;
+
+#endif
@@ -0,0 +1,134 @@
+/*
+ * VncConnectionStatistics.h - declaration of VncConnectionStatistics class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef VNC_CONNECTION_STATISTICS_H
+#define VNC_CONNECTION_STATISTICS_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QMap>
+#include <QMutex>
+
+#include "VeyonCore.h"
+
+/*!
+ * \brief Collects performance counters and histograms of a VeyonVncConnection
+ *
+ * Recording is cheap enough to be done for every framebuffer update. All methods are thread-safe
+ * so statistics can be recorded by the VncConnectionEngine threads and read from the GUI thread.
+ * Times are recorded in microseconds.
+ */
+class VEYON_CORE_EXPORT VncConnectionStatistics
+{
+public:
+	/*!
+	 * \brief Histogram with logarithmic buckets (powers of two)
+	 */
+	class VEYON_CORE_EXPORT Histogram
+	{
+	public:
+		enum {
+			BucketCount = 32
+		};
+
+		Histogram();
+
+		void record( qint64 value );
+
+		qint64 count() const
+		{
+			return m_count;
+		}
+
+		qint64 average() const
+		{
+			return m_count > 0 ? m_sum / m_count : 0;
+		}
+
+		qint64 maximum() const
+		{
+			return m_maximum;
+		}
+
+		/** \brief Returns upper bound of the bucket containing the given percentile */
+		qint64 percentile( int percent ) const;
+
+		QJsonObject toJson() const;
+
+	private:
+		qint64 m_buckets[BucketCount];
+		qint64 m_count;
+		qint64 m_sum;
+		qint64 m_maximum;
+
+	} ;
+
+	enum {
+		RateWindow = 1000
+	};
+
+	VncConnectionStatistics();
+
+	void reset();
+
+	/*!
+	 * \brief Records a completed framebuffer update
+	 * \param bytes number of bytes received for the update or -1 if unknown
+	 * \param latency time since the update has been requested or -1 if not requested explicitly
+	 * \param encoding name of the encoding used for the update
+	 * \param decodeTime time it took to receive and decode the update message
+	 */
+	void recordUpdate( qint64 bytes, qint64 latency, const QString& encoding, qint64 decodeTime );
+	void recordScaling( qint64 scaleTime );
+
+	double updatesPerSecond() const;
+
+	QJsonObject toJson() const;
+
+	/** \brief Returns a single line summary suitable for overlays */
+	QString summary() const;
+
+	/*!
+	 * \brief Returns the number of bytes received on given TCP socket so far
+	 * \return -1 if the platform does not report received bytes (supported on Linux and Windows 10 1703 or newer)
+	 */
+	static qint64 socketBytesReceived( int socket );
+
+private:
+	double currentUpdatesPerSecond() const;
+
+	mutable QMutex m_mutex;
+	QElapsedTimer m_rateTimer;
+	int m_windowUpdateCount;
+	double m_updatesPerSecond;
+	qint64 m_updateCount;
+	qint64 m_totalBytes;
+	Histogram m_updateBytes;
+	Histogram m_updateLatency;
+	Histogram m_scaleTime;
+	QMap<QString, Histogram> m_decodeTimes;
+
+} ;
+
+#endif
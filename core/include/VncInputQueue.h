@@ -0,0 +1,108 @@
+/*
+ * VncInputQueue.h - declaration of VncInputQueue class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef VNC_INPUT_QUEUE_H
+#define VNC_INPUT_QUEUE_H
+
+#include <QAtomicInteger>
+#include <QMutex>
+#include <QVector>
+
+#include "VeyonCore.h"
+
+/*!
+ * \brief Preallocated single-producer/single-consumer ring for pointer and key events
+ *
+ * Events are enqueued by the GUI thread and drained by the VncConnectionEngine thread without
+ * locking or allocating memory. When draining, consecutive pointer moves, i.e. pointer events which do
+ * not change the button state, are merged into the most recent one. Pointer events changing the button
+ * state and key events are always preserved.
+ *
+ * If the ring is full, the producer appends to a mutex-protected overflow list instead until the consumer
+ * has caught up. Pointer moves are merged right away there, so no event other than a move gets lost.
+ */
+class VEYON_CORE_EXPORT VncInputQueue
+{
+public:
+	enum {
+		Capacity = 512
+	};
+
+	struct Event
+	{
+		enum Type {
+			Pointer,
+			Key
+		} type;
+		int x;
+		int y;
+		int buttonMask;
+		unsigned int key;
+		bool pressed;
+	};
+
+	VncInputQueue();
+
+	// producer side
+	bool enqueuePointerEvent( int x, int y, int buttonMask );
+	bool enqueueKeyEvent( unsigned int key, bool pressed );
+
+	// consumer side
+	/*!
+	 * \brief Takes all queued events and merges consecutive pointer moves
+	 * \param events vector replaced with the taken events, its capacity is kept
+	 * \return number of events written to \a events
+	 */
+	int drain( QVector<Event>& events );
+	void clear();
+
+	bool isEmpty() const
+	{
+		return m_head.loadAcquire() == m_tail.loadAcquire();
+	}
+
+private:
+	bool enqueue( const Event& event );
+
+	void takeRingEvents( QVector<Event>& events, bool& lastEventIsMove );
+	void appendEvent( QVector<Event>& events, const Event& event, bool& lastEventIsMove );
+
+	Event m_events[Capacity];
+	QAtomicInteger<quint32> m_head;
+	QAtomicInteger<quint32> m_tail;
+
+	// producer side: button state after the most recently enqueued pointer event
+	int m_enqueuedButtonMask;
+
+	// consumer side: button state after the most recently drained pointer event
+	int m_buttonMask;
+
+	QMutex m_overflowLock;
+	QVector<Event> m_overflowEvents;
+	bool m_lastOverflowEventIsMove;
+	QAtomicInteger<int> m_overflowing;
+
+} ;
+
+#endif
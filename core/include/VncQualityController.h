@@ -0,0 +1,146 @@
+/*
+ * VncQualityController.h - declaration of VncQualityController class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef VNC_QUALITY_CONTROLLER_H
+#define VNC_QUALITY_CONTROLLER_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+
+#include "VeyonCore.h"
+
+/*!
+ * \brief Adapts encoding parameters of a VeyonVncConnection to the measured link capacity
+ *
+ * The controller measures how long it takes to transfer framebuffer updates and derives the link
+ * throughput from it. Whenever transfers take longer than the target transfer time, the controller
+ * moves one step towards cheaper settings (lower JPEG quality, higher compression level, longer
+ * update interval, compressing encodings first). It moves back only after several windows with fast
+ * transfers, or immediately on high throughput links. All settings stay within the bounds given for
+ * the quality level of the connection.
+ *
+ * The controller is not thread-safe and is only used by the VncConnectionEngine thread of the
+ * connection except for step().
+ */
+class VEYON_CORE_EXPORT VncQualityController
+{
+public:
+	enum {
+		StepCount = 5,
+		AdjustmentInterval = 2000,
+		MinimumSampleCount = 3,
+		RecoveryWindowCount = 3,
+		FastLinkThroughput = 10 * 1024 * 1024,
+	};
+
+	struct Bounds
+	{
+		int minimumQualityLevel;
+		int maximumQualityLevel;
+		int minimumCompressLevel;
+		int maximumCompressLevel;
+		int maximumUpdateIntervalFactor;
+		int targetTransferTime;				/**< in ms, 0 disables adaptation */
+		const char* encodings;				/**< used on unconstrained links */
+		const char* constrainedEncodings;	/**< used as soon as the link is constrained */
+		bool lossyEncodingAllowed;
+	};
+
+	struct Settings
+	{
+		int qualityLevel;
+		int compressLevel;
+		int updateInterval;
+		const char* encodings;
+		bool enableJPEG;
+	};
+
+	VncQualityController();
+
+	void setEnabled( bool enabled )
+	{
+		m_enabled = enabled;
+	}
+
+	/*!
+	 * \brief Starts over with best settings, e.g. after (re)connecting
+	 */
+	void reset( const Bounds& bounds, int baseUpdateInterval );
+
+	/*!
+	 * \brief Changes bounds and base update interval while keeping the current step
+	 * \return whether resulting settings have changed
+	 */
+	bool setBounds( const Bounds& bounds, int baseUpdateInterval );
+
+	/*!
+	 * \brief Records a framebuffer update
+	 * \param bytes number of bytes received for the update or -1 if unknown
+	 * \param transferTime time in microseconds it took to receive and decode the update
+	 */
+	void recordUpdate( qint64 bytes, qint64 transferTime );
+
+	/*!
+	 * \brief Evaluates recorded updates if the current adjustment window has passed
+	 * \return whether settings have changed
+	 */
+	bool adjust();
+
+	const Settings& settings() const
+	{
+		return m_settings;
+	}
+
+	/** \brief Returns current step (0 = best settings within bounds), safe to call from any thread */
+	int step() const
+	{
+		return m_step.loadAcquire();
+	}
+
+	/** \brief Returns estimated link throughput in bytes per second or 0 if unknown */
+	qint64 throughput() const
+	{
+		return m_throughput;
+	}
+
+private:
+	void updateSettings();
+	static int interpolate( int best, int worst, int step );
+
+	bool m_enabled;
+	Bounds m_bounds;
+	int m_baseUpdateInterval;
+	Settings m_settings;
+	QAtomicInt m_step;
+
+	QElapsedTimer m_windowTimer;
+	int m_sampleCount;
+	qint64 m_windowTransferTime;
+	qint64 m_windowBytes;
+	qint64 m_throughput;
+	int m_fastWindowCount;
+
+} ;
+
+#endif
@@ -121,6 +121,7 @@ private:
 	QPoint mapToFramebuffer( QPoint pos );
 	QRect mapFromFramebuffer( QRect rect );
 
+	void updateScaledImage( const QImage& image );
 	void updateLocalCursor();
 	void pressKey( unsigned int key );
 	void unpressKey( unsigned int key );
@@ -132,6 +133,8 @@ private:
 	int m_cursorX;
 	int m_cursorY;
 	QSize m_framebufferSize;
+	QImage m_scaledImage;
+	QRegion m_scaledImageDamage;
 	int m_cursorHotX;
 	int m_cursorHotY;
 	bool m_viewOnly;
@@ -22,10 +22,14 @@
  *
  */
 
+#include <QTimer>
+
 #include "BuiltinFeatures.h"
 #include "ComputerControlInterface.h"
 #include "Computer.h"
 #include "FeatureControl.h"
+#include "FeatureMessage.h"
+#include "HostResolver.h"
 #include "UserSessionControl.h"
 #include "VeyonConfiguration.h"
 #include "VeyonCoreConnection.h"
@@ -42,14 +46,29 @@ ComputerControlInterface::ComputerControlInterface( const Computer& computer,
 	m_vncConnection( nullptr ),
 	m_coreConnection( nullptr ),
 	m_builtinFeatures( nullptr ),
-	m_screenUpdated( false )
+	m_screenGeneration( 0 ),
+	m_updatesPaused( false ),
+	m_focused( false ),
+	m_statePollingTimer( new QTimer( this ) ),
+	m_fullResolutionConnection( nullptr ),
+	m_fullResolutionTimeoutTimer( new QTimer( this ) ),
+	m_lastFeatureRequestId( 0 ),
+	m_pendingFeatureRequests()
 {
+	m_fullResolutionTimeoutTimer->setSingleShot( true );
+	m_fullResolutionTimeoutTimer->setInterval( FullResolutionScreenTimeout );
+	connect( m_fullResolutionTimeoutTimer, &QTimer::timeout, this, &ComputerControlInterface::finishFullResolutionScreenGrab );
+
+	m_statePollingTimer->setInterval( StatePollingInterval );
+	connect( m_statePollingTimer, &QTimer::timeout, this, &ComputerControlInterface::updateUser );
+	connect( m_statePollingTimer, &QTimer::timeout, this, &ComputerControlInterface::updateActiveFeatures );
 }
 
 
 
 ComputerControlInterface::~ComputerControlInterface()
 {
+	stopFullResolutionScreenGrab();
 	stop();
 }
 
@@ -77,18 +96,20 @@ void ComputerControlInterface::start( QSize scaledScreenSize, BuiltinFeatures* b
 		m_vncConnection->setQuality( VeyonVncConnection::ThumbnailQuality );
 		m_vncConnection->setScaledSize( m_scaledScreenSize );
 		m_vncConnection->setFramebufferUpdateInterval( VeyonCore::config().computerMonitoringUpdateInterval() );
+		m_vncConnection->setFramebufferUpdatesPaused( m_updatesPaused );
+		m_vncConnection->setFocused( m_focused );
+
+		// resolve host name in background while the connection waits for admission
+		VeyonCore::hostResolver().prefetch( { m_vncConnection->host() } );
 
 		m_coreConnection = new VeyonCoreConnection( m_vncConnection );
 
 		m_vncConnection->start();
 
-		connect( m_vncConnection, &VeyonVncConnection::framebufferUpdateComplete, this, &ComputerControlInterface::setScreenUpdateFlag );
-		connect( m_vncConnection, &VeyonVncConnection::framebufferUpdateComplete ,this, &ComputerControlInterface::updateUser );
-		connect( m_vncConnection, &VeyonVncConnection::framebufferUpdateComplete, this, &ComputerControlInterface::updateActiveFeatures );
+		connect( m_vncConnection, &VeyonVncConnection::scaledScreenUpdated, this, &ComputerControlInterface::updateScreenGeneration );
 
+		// user and active features are pushed by the server after subscribing once connected
 		connect( m_vncConnection, &VeyonVncConnection::stateChanged, this, &ComputerControlInterface::updateState );
-		connect( m_vncConnection, &VeyonVncConnection::stateChanged, this, &ComputerControlInterface::updateUser );
-		connect( m_vncConnection, &VeyonVncConnection::stateChanged, this, &ComputerControlInterface::updateActiveFeatures );
 
 		connect( m_coreConnection, &VeyonCoreConnection::featureMessageReceived,
 				 this, &ComputerControlInterface::handleFeatureMessage );
@@ -116,11 +137,34 @@ void ComputerControlInterface::stop()
 		m_vncConnection = nullptr;
 	}
 
+	m_statePollingTimer->stop();
+	m_pendingFeatureRequests.clear();
+
 	m_state = Disconnected;
 }
 
 
 
+void ComputerControlInterface::setComputer( const Computer& computer )
+{
+	const auto hostAddressChanged = computer.hostAddress() != m_computer.hostAddress();
+
+	m_computer = computer;
+
+	// connect to new host immediately if started already
+	if( hostAddressChanged && m_builtinFeatures )
+	{
+		start( m_scaledScreenSize, m_builtinFeatures );
+	}
+	else
+	{
+		// entry may have been edited after fixing the computer so retry to connect immediately
+		resetReconnectBackoff();
+	}
+}
+
+
+
 void ComputerControlInterface::setScaledScreenSize( QSize scaledScreenSize )
 {
 	m_scaledScreenSize = scaledScreenSize;
@@ -130,7 +174,7 @@ void ComputerControlInterface::setScaledScreenSize( QSize scaledScreenSize )
 		m_vncConnection->setScaledSize( m_scaledScreenSize );
 	}
 
-	setScreenUpdateFlag();
+	updateScreenGeneration();
 }
 
 
@@ -147,9 +191,52 @@ QImage ComputerControlInterface::scaledScreen() const
 
 
 
-QImage ComputerControlInterface::screen() const
+int ComputerControlInterface::screenActivity() const
 {
 	if( m_vncConnection && m_vncConnection->isConnected() )
+	{
+		return m_vncConnection->screenActivity();
+	}
+
+	return 0;
+}
+
+
+
+QJsonObject ComputerControlInterface::connectionStatistics() const
+{
+	if( m_vncConnection )
+	{
+		auto statistics = m_vncConnection->statistics().toJson();
+		statistics[QStringLiteral("connectLatency")] = m_vncConnection->connectLatency();
+		statistics[QStringLiteral("qualityStep")] = m_vncConnection->qualityStep();
+		statistics[QStringLiteral("screenActivity")] = m_vncConnection->screenActivity();
+		return statistics;
+	}
+
+	return QJsonObject();
+}
+
+
+
+QString ComputerControlInterface::connectionStatisticsSummary() const
+{
+	if( m_vncConnection )
+	{
+		return m_vncConnection->statistics().summary();
+	}
+
+	return QString();
+}
+
+
+
+QImage ComputerControlInterface::screen() const
+{
+	if( m_vncConnection && m_vncConnection->isConnected() &&
+			// framebuffer of thumbnail connection only has the size of the thumbnail or is outdated
+			m_vncConnection->isFramebufferScaledByServer() == false &&
+			m_vncConnection->areFramebufferUpdatesPaused() == false )
 	{
 		return m_vncConnection->image();
 	}
@@ -159,12 +246,132 @@ QImage ComputerControlInterface::screen() const
 
 
 
+void ComputerControlInterface::grabFullResolutionScreen()
+{
+	const auto liveScreen = screen();
+	if( liveScreen.isNull() == false )
+	{
+		emit fullResolutionScreenGrabbed( liveScreen );
+		return;
+	}
+
+	// pending grab notifies all receivers when finished
+	if( m_fullResolutionConnection )
+	{
+		return;
+	}
+
+	if( m_computer.hostAddress().isEmpty() )
+	{
+		emit fullResolutionScreenGrabbed( QImage() );
+		return;
+	}
+
+	m_fullResolutionConnection = new VeyonVncConnection;
+	m_fullResolutionConnection->setHost( m_computer.hostAddress() );
+	m_fullResolutionConnection->setQuality( VeyonVncConnection::ScreenshotQuality );
+
+	connect( m_fullResolutionConnection, &VeyonVncConnection::framebufferUpdateComplete,
+			 this, &ComputerControlInterface::finishFullResolutionScreenGrab );
+
+	m_fullResolutionTimeoutTimer->start();
+	m_fullResolutionConnection->start();
+}
+
+
+
+void ComputerControlInterface::finishFullResolutionScreenGrab()
+{
+	if( m_fullResolutionConnection == nullptr )
+	{
+		return;
+	}
+
+	QImage image;
+	if( m_fullResolutionConnection->hasValidFrameBuffer() )
+	{
+		image = m_fullResolutionConnection->image();
+	}
+	else if( m_fullResolutionTimeoutTimer->isActive() )
+	{
+		// first update only initializes the framebuffer - wait for its contents
+		return;
+	}
+	else
+	{
+		qWarning() << "ComputerControlInterface::finishFullResolutionScreenGrab(): timeout while grabbing screen of"
+				   << m_computer.hostAddress();
+	}
+
+	stopFullResolutionScreenGrab();
+
+	emit fullResolutionScreenGrabbed( image );
+}
+
+
+
+void ComputerControlInterface::stopFullResolutionScreenGrab()
+{
+	m_fullResolutionTimeoutTimer->stop();
+
+	if( m_fullResolutionConnection )
+	{
+		m_fullResolutionConnection->disconnect( this );
+
+		// let connection delete itself after stopping
+		m_fullResolutionConnection->stop( true );
+		m_fullResolutionConnection = nullptr;
+	}
+}
+
+
+
+void ComputerControlInterface::setUpdatesPaused( bool paused )
+{
+	if( paused != m_updatesPaused )
+	{
+		m_updatesPaused = paused;
+
+		if( m_vncConnection )
+		{
+			m_vncConnection->setFramebufferUpdatesPaused( m_updatesPaused );
+		}
+	}
+}
+
+
+
+void ComputerControlInterface::setFocused( bool focused )
+{
+	m_focused = focused;
+
+	if( m_vncConnection )
+	{
+		m_vncConnection->setFocused( m_focused );
+	}
+}
+
+
+
+void ComputerControlInterface::resetReconnectBackoff()
+{
+	if( m_vncConnection )
+	{
+		m_vncConnection->resetReconnectBackoff();
+	}
+}
+
+
+
 void ComputerControlInterface::setUser( const QString& user )
 {
 	if( user != m_user )
 	{
 		m_user = user;
 
+		// user name is displayed along with the screen
+		updateScreenGeneration();
+
 		emit userChanged();
 	}
 }
@@ -192,6 +399,13 @@ void ComputerControlInterface::setDesignatedModeFeature( Feature::Uid designated
 
 
 
+void ComputerControlInterface::setStateNotificationsSubscribed()
+{
+	m_statePollingTimer->stop();
+}
+
+
+
 void ComputerControlInterface::sendFeatureMessage( const FeatureMessage& featureMessage )
 {
 	if( m_coreConnection && m_coreConnection->isConnected() )
@@ -202,6 +416,68 @@ void ComputerControlInterface::sendFeatureMessage( const FeatureMessage& feature
 
 
 
+bool ComputerControlInterface::sendFeatureRequest( const FeatureMessage& request )
+{
+	if( m_coreConnection == nullptr || m_coreConnection->isConnected() == false )
+	{
+		return false;
+	}
+
+	const FeatureRequestKey key( request.featureUid(), request.command() );
+
+	auto it = m_pendingFeatureRequests.find( key );
+	if( it != m_pendingFeatureRequests.end() && it->age.hasExpired( FeatureRequestTimeout ) == false )
+	{
+		// identical query still in flight
+		return false;
+	}
+
+	// skip 0 after wrap-around as it denotes messages without request ID
+	if( ++m_lastFeatureRequestId == 0 )
+	{
+		++m_lastFeatureRequestId;
+	}
+
+	auto& pendingRequest = m_pendingFeatureRequests[key];
+	pendingRequest.requestId = m_lastFeatureRequestId;
+	pendingRequest.age.start();
+
+	FeatureMessage message( request );
+	message.setRequestId( m_lastFeatureRequestId );
+
+	m_coreConnection->sendFeatureMessage( message );
+
+	return true;
+}
+
+
+
+void ComputerControlInterface::sendFeatureMessage( const FeatureMessage& featureMessage,
+												   const QVector<Pointer>& computerControlInterfaces )
+{
+	if( computerControlInterfaces.isEmpty() )
+	{
+		return;
+	}
+
+	qDebug() << "ComputerControlInterface::sendFeatureMessage(): sending message" << featureMessage.featureUid()
+			 << "command" << featureMessage.command()
+			 << "arguments" << featureMessage.arguments()
+			 << "to" << computerControlInterfaces.size() << "computers";
+
+	const auto encodedMessage = VeyonCoreConnection::encodeFeatureMessage( featureMessage );
+
+	for( const auto& controlInterface : computerControlInterfaces )
+	{
+		if( controlInterface->m_coreConnection && controlInterface->m_coreConnection->isConnected() )
+		{
+			controlInterface->m_coreConnection->sendEncodedFeatureMessage( encodedMessage );
+		}
+	}
+}
+
+
+
 void ComputerControlInterface::updateState()
 {
 	if( m_vncConnection )
@@ -222,7 +498,36 @@ void ComputerControlInterface::updateState()
 		m_state = Disconnected;
 	}
 
-	setScreenUpdateFlag();
+	if( m_state == Connected )
+	{
+		subscribeStateNotifications();
+	}
+	else
+	{
+		m_statePollingTimer->stop();
+
+		// replies to queries sent through the previous connection will never arrive
+		m_pendingFeatureRequests.clear();
+
+		setUser( QString() );
+		setActiveFeatures( {} );
+	}
+
+	updateScreenGeneration();
+}
+
+
+
+void ComputerControlInterface::subscribeStateNotifications()
+{
+	if( m_coreConnection && m_statePollingTimer->isActive() == false )
+	{
+		m_builtinFeatures->userSessionControl().subscribeUserSessionInfo( { weakPointer() } );
+		m_builtinFeatures->featureControl().subscribeActiveFeatures( { weakPointer() } );
+
+		// poll until the server confirms the subscription
+		m_statePollingTimer->start();
+	}
 }
 
 
@@ -260,5 +565,39 @@ void ComputerControlInterface::updateActiveFeatures()
 
 void ComputerControlInterface::handleFeatureMessage( const FeatureMessage& message )
 {
+	if( isExpectedFeatureReply( message ) == false )
+	{
+		qDebug() << "ComputerControlInterface::handleFeatureMessage(): dropping stale reply" << message.requestId()
+				 << "for feature" << message.featureUid() << "command" << message.command();
+		return;
+	}
+
 	emit featureMessageReceived( message, weakPointer() );
 }
+
+
+
+bool ComputerControlInterface::isExpectedFeatureReply( const FeatureMessage& message )
+{
+	const FeatureRequestKey key( message.featureUid(), message.command() );
+
+	auto it = m_pendingFeatureRequests.find( key );
+	if( message.requestId() == 0 )
+	{
+		// notification or server without request ID support (replying in order)
+		if( it != m_pendingFeatureRequests.end() )
+		{
+			m_pendingFeatureRequests.erase( it );
+		}
+		return true;
+	}
+
+	if( it == m_pendingFeatureRequests.end() || it->requestId != message.requestId() )
+	{
+		return false;
+	}
+
+	m_pendingFeatureRequests.erase( it );
+
+	return true;
+}
@@ -49,7 +49,15 @@ FeatureControl::~FeatureControl()
 
 bool FeatureControl::queryActiveFeatures( const ComputerControlInterfaceList& computerControlInterfaces )
 {
-	return sendFeatureMessage( FeatureMessage( m_featureControlFeature.uid(), QueryActiveFeatures ),
+	return sendFeatureRequest( FeatureMessage( m_featureControlFeature.uid(), QueryActiveFeatures ),
+							   computerControlInterfaces );
+}
+
+
+
+bool FeatureControl::subscribeActiveFeatures( const ComputerControlInterfaceList& computerControlInterfaces )
+{
+	return sendFeatureRequest( FeatureMessage( m_featureControlFeature.uid(), SubscribeActiveFeatures ),
 							   computerControlInterfaces );
 }
 
@@ -64,6 +72,12 @@ bool FeatureControl::handleFeatureMessage( VeyonMasterInterface& master, const F
 	{
 		computerControlInterface->setActiveFeatures( message.argument( ActiveFeatureList ).toStringList() );
 
+		// servers not supporting subscriptions reply without this argument
+		if( message.argument( Subscribed ).toBool() )
+		{
+			computerControlInterface->setStateNotificationsSubscribed();
+		}
+
 		return true;
 	}
 
@@ -76,15 +90,73 @@ bool FeatureControl::handleFeatureMessage( VeyonServerInterface& server, const F
 {
 	if( m_featureControlFeature.uid() == message.featureUid() )
 	{
-		FeatureMessage reply( message.featureUid(), message.command() );
-		reply.addArgument( ActiveFeatureList, server.featureWorkerManager().runningWorkers() );
-
-		char rfbMessageType = rfbVeyonFeatureMessage;
-		message.ioDevice()->write( &rfbMessageType, sizeof(rfbMessageType) );
-		reply.send( message.ioDevice() );
+		const auto activeFeatures = server.featureWorkerManager().runningWorkers();
+
+		if( message.command() == SubscribeActiveFeatures )
+		{
+			if( m_featureWorkerManager.isNull() )
+			{
+				m_featureWorkerManager = &server.featureWorkerManager();
+				connect( m_featureWorkerManager, &FeatureWorkerManager::runningWorkersChanged,
+						 this, &FeatureControl::sendActiveFeaturesToSubscribers );
+			}
+
+			if( m_subscribers.contains( message.ioDevice() ) == false )
+			{
+				m_subscribers.append( message.ioDevice() );
+			}
+			m_activeFeatures = activeFeatures;
+		}
+
+		sendActiveFeatures( message.ioDevice(), message.command(), message.requestId(), activeFeatures,
+							message.command() == SubscribeActiveFeatures );
 
 		return true;
 	}
 
 	return false;
 }
+
+
+
+void FeatureControl::sendActiveFeaturesToSubscribers()
+{
+	if( m_featureWorkerManager.isNull() )
+	{
+		return;
+	}
+
+	const auto activeFeatures = m_featureWorkerManager->runningWorkers();
+	if( activeFeatures == m_activeFeatures )
+	{
+		return;
+	}
+
+	m_activeFeatures = activeFeatures;
+
+	m_subscribers.removeAll( QPointer<QIODevice>() );
+
+	for( const auto& subscriber : qAsConst(m_subscribers) )
+	{
+		sendActiveFeatures( subscriber, SubscribeActiveFeatures, 0, m_activeFeatures, true );
+	}
+}
+
+
+
+void FeatureControl::sendActiveFeatures( QIODevice* ioDevice, FeatureMessage::Command command,
+										 FeatureMessage::RequestId requestId,
+										 const FeatureUidList& activeFeatures, bool subscribed ) const
+{
+	FeatureMessage reply( m_featureControlFeature.uid(), command );
+	reply.setRequestId( requestId );
+	reply.addArgument( ActiveFeatureList, activeFeatures );
+	if( subscribed )
+	{
+		reply.addArgument( Subscribed, true );
+	}
+
+	char rfbMessageType = rfbVeyonFeatureMessage;
+	ioDevice->write( &rfbMessageType, sizeof(rfbMessageType) );
+	reply.send( ioDevice );
+}
@@ -42,6 +42,8 @@ bool FeatureMessage::send( QIODevice* ioDevice ) const
 		message.write( m_featureUid );
 		message.write( m_command );
 		message.write( m_arguments );
+		// appended last so peers not knowing about request IDs simply ignore it
+		message.write( m_requestId );
 
 		return message.send();
 	}
@@ -77,6 +79,7 @@ bool FeatureMessage::receive()
 			m_command = message.read().value<Command>(); // Flawfinder: ignore
 #endif
 			m_arguments = message.read().toMap(); // Flawfinder: ignore
+			m_requestId = message.atEnd() ? 0 : message.read().toUInt(); // Flawfinder: ignore
 			return true;
 		}
 
@@ -110,6 +110,8 @@ void FeatureWorkerManager::startWorker( const Feature& feature, WorkerProcessMod
 	m_workersMutex.lock();
 	m_workers[feature.uid()] = worker;
 	m_workersMutex.unlock();
+
+	emit runningWorkersChanged();
 }
 
 
@@ -125,7 +127,9 @@ void FeatureWorkerManager::stopWorker( const Feature &feature )
 
 	m_workersMutex.lock();
 
-	if( m_workers.contains( feature.uid() ) )
+	const auto workerRunning = m_workers.contains( feature.uid() );
+
+	if( workerRunning )
 	{
 		qDebug() << "Stopping worker for feature" << feature.displayName() << feature.uid();
 
@@ -153,6 +157,11 @@ void FeatureWorkerManager::stopWorker( const Feature &feature )
 	}
 
 	m_workersMutex.unlock();
+
+	if( workerRunning )
+	{
+		emit runningWorkersChanged();
+	}
 }
 
 
@@ -249,12 +258,15 @@ void FeatureWorkerManager::closeConnection( QTcpSocket* socket )
 {
 	m_workersMutex.lock();
 
+	bool workersRemoved = false;
+
 	for( auto it = m_workers.begin(); it != m_workers.end(); )
 	{
 		if( it.value().socket == socket )
 		{
 			qDebug() << "FeatureWorkerManager::closeConnection(): removing worker after socket has been closed";
 			it = m_workers.erase( it );
+			workersRemoved = true;
 		}
 		else
 		{
@@ -264,6 +276,11 @@ void FeatureWorkerManager::closeConnection( QTcpSocket* socket )
 
 	m_workersMutex.unlock();
 
+	if( workersRemoved )
+	{
+		emit runningWorkersChanged();
+	}
+
 	socket->deleteLater();
 }
 
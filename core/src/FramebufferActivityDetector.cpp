@@ -0,0 +1,360 @@
+/*
+ * FramebufferActivityDetector.cpp - implementation of FramebufferActivityDetector class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QMutexLocker>
+#include <QtMath>
+
+#include <algorithm>
+
+#include "FramebufferActivityDetector.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#if defined(__SSE2__) || defined(_M_X64)
+#define ACTIVITY_DETECTOR_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__)
+#define ACTIVITY_DETECTOR_AVX2
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define ACTIVITY_DETECTOR_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+static constexpr int BlockSize = FramebufferActivityDetector::BlockSize;
+static constexpr quint32 HashSeed = 5381;
+
+static_assert( BlockSize == 16, "vectorized hash functions process 16 pixels per row" );
+
+// every pixel column of a block has its own hash lane which is updated per row as lane = lane * 33 ^ pixel,
+// so all implementations produce identical results
+using HashRowsFunction = void (*)( quint32* lanes, const quint8* source, int stride, int rows );
+
+
+static void hashRowsGeneric( quint32* lanes, const quint8* source, int stride, int columns, int rows )
+{
+	for( int y = 0; y < rows; ++y )
+	{
+		const auto line = reinterpret_cast<const quint32 *>( source + y * stride );
+		for( int x = 0; x < columns; ++x )
+		{
+			lanes[x] = ( lanes[x] * 33 ) ^ line[x];
+		}
+	}
+}
+
+
+#if !defined(ACTIVITY_DETECTOR_SSE2) && !defined(ACTIVITY_DETECTOR_NEON)
+static void hashRowsGenericFull( quint32* lanes, const quint8* source, int stride, int rows )
+{
+	hashRowsGeneric( lanes, source, stride, BlockSize, rows );
+}
+#endif
+
+
+#ifdef ACTIVITY_DETECTOR_SSE2
+static void hashRowsSse2( quint32* lanes, const quint8* source, int stride, int rows )
+{
+	__m128i hash[4];
+	for( int i = 0; i < 4; ++i )
+	{
+		hash[i] = _mm_loadu_si128( reinterpret_cast<const __m128i *>( lanes + i * 4 ) );
+	}
+
+	for( int y = 0; y < rows; ++y )
+	{
+		const auto line = reinterpret_cast<const __m128i *>( source + y * stride );
+		for( int i = 0; i < 4; ++i )
+		{
+			hash[i] = _mm_xor_si128( _mm_add_epi32( _mm_slli_epi32( hash[i], 5 ), hash[i] ), _mm_loadu_si128( line + i ) );
+		}
+	}
+
+	for( int i = 0; i < 4; ++i )
+	{
+		_mm_storeu_si128( reinterpret_cast<__m128i *>( lanes + i * 4 ), hash[i] );
+	}
+}
+#endif
+
+
+#ifdef ACTIVITY_DETECTOR_AVX2
+__attribute__((target("avx2")))
+static void hashRowsAvx2( quint32* lanes, const quint8* source, int stride, int rows )
+{
+	auto hashLow = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( lanes ) );
+	auto hashHigh = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( lanes + 8 ) );
+
+	for( int y = 0; y < rows; ++y )
+	{
+		const auto line = reinterpret_cast<const __m256i *>( source + y * stride );
+		hashLow = _mm256_xor_si256( _mm256_add_epi32( _mm256_slli_epi32( hashLow, 5 ), hashLow ), _mm256_loadu_si256( line ) );
+		hashHigh = _mm256_xor_si256( _mm256_add_epi32( _mm256_slli_epi32( hashHigh, 5 ), hashHigh ), _mm256_loadu_si256( line + 1 ) );
+	}
+
+	_mm256_storeu_si256( reinterpret_cast<__m256i *>( lanes ), hashLow );
+	_mm256_storeu_si256( reinterpret_cast<__m256i *>( lanes + 8 ), hashHigh );
+}
+#endif
+
+
+#ifdef ACTIVITY_DETECTOR_NEON
+static void hashRowsNeon( quint32* lanes, const quint8* source, int stride, int rows )
+{
+	uint32x4_t hash[4];
+	for( int i = 0; i < 4; ++i )
+	{
+		hash[i] = vld1q_u32( lanes + i * 4 );
+	}
+
+	for( int y = 0; y < rows; ++y )
+	{
+		const auto line = reinterpret_cast<const uint32_t *>( source + y * stride );
+		for( int i = 0; i < 4; ++i )
+		{
+			hash[i] = veorq_u32( vaddq_u32( vshlq_n_u32( hash[i], 5 ), hash[i] ), vld1q_u32( line + i * 4 ) );
+		}
+	}
+
+	for( int i = 0; i < 4; ++i )
+	{
+		vst1q_u32( lanes + i * 4, hash[i] );
+	}
+}
+#endif
+
+
+static HashRowsFunction selectHashRowsFunction()
+{
+#ifdef ACTIVITY_DETECTOR_AVX2
+	__builtin_cpu_init();
+	if( __builtin_cpu_supports( "avx2" ) )
+	{
+		return hashRowsAvx2;
+	}
+#endif
+#ifdef ACTIVITY_DETECTOR_SSE2
+	return hashRowsSse2;
+#elif defined(ACTIVITY_DETECTOR_NEON)
+	return hashRowsNeon;
+#else
+	return hashRowsGenericFull;
+#endif
+}
+
+
+static const HashRowsFunction hashRows = selectHashRowsFunction();
+
+}
+
+
+
+FramebufferActivityDetector::FramebufferActivityDetector() :
+	m_size(),
+	m_columns( 0 ),
+	m_blockHashes(),
+	m_damagedBlocks(),
+	m_blockQueue(),
+	m_mutex(),
+	m_clock(),
+	m_lastChange( 0 ),
+	m_activity( 0 )
+{
+	m_clock.start();
+}
+
+
+
+void FramebufferActivityDetector::reset()
+{
+	// force rehashing all blocks without counting them as changed
+	m_size = QSize();
+
+	QMutexLocker locker( &m_mutex );
+	m_clock.start();
+	m_lastChange = 0;
+	m_activity = 0;
+}
+
+
+
+void FramebufferActivityDetector::update( const QImage& image, const QRegion& damage )
+{
+	if( image.isNull() || image.depth() != 32 )
+	{
+		return;
+	}
+
+	if( image.size() != m_size )
+	{
+		hashAll( image );
+		return;
+	}
+
+	// collect each block covered by the damaged region once
+	m_blockQueue.clear();
+
+	const auto rects = damage.rects();
+	for( const auto& rect : rects )
+	{
+		const auto area = rect.intersected( image.rect() );
+		if( area.isEmpty() )
+		{
+			continue;
+		}
+
+		for( int y = area.top() / BlockSize; y <= area.bottom() / BlockSize; ++y )
+		{
+			for( int x = area.left() / BlockSize; x <= area.right() / BlockSize; ++x )
+			{
+				const auto blockIndex = y * m_columns + x;
+				if( m_damagedBlocks[blockIndex] == false )
+				{
+					m_damagedBlocks[blockIndex] = true;
+					m_blockQueue.append( blockIndex );
+				}
+			}
+		}
+	}
+
+	qint64 changedPixels = 0;
+
+	for( auto blockIndex : qAsConst(m_blockQueue) )
+	{
+		m_damagedBlocks[blockIndex] = false;
+		changedPixels += hashBlock( image, blockIndex );
+	}
+
+	if( changedPixels > 0 )
+	{
+		recordChange( double( changedPixels ) / ( qint64( image.width() ) * image.height() ) );
+	}
+}
+
+
+
+int FramebufferActivityDetector::activity() const
+{
+	QMutexLocker locker( &m_mutex );
+
+	return activityLevel( m_clock.elapsed() );
+}
+
+
+
+bool FramebufferActivityDetector::isIdle() const
+{
+	QMutexLocker locker( &m_mutex );
+
+	const auto now = m_clock.elapsed();
+
+	// require a full measurement period before considering a screen idle
+	return now >= TimeConstant && activityLevel( now ) < IdleActivity;
+}
+
+
+
+void FramebufferActivityDetector::hashAll( const QImage& image )
+{
+	m_size = image.size();
+	m_columns = ( m_size.width() + BlockSize - 1 ) / BlockSize;
+
+	const auto blockCount = m_columns * ( ( m_size.height() + BlockSize - 1 ) / BlockSize );
+
+	m_blockHashes.fill( 0, blockCount );
+	m_damagedBlocks.fill( false, blockCount );
+
+	for( int blockIndex = 0; blockIndex < blockCount; ++blockIndex )
+	{
+		hashBlock( image, blockIndex );
+	}
+}
+
+
+
+int FramebufferActivityDetector::hashBlock( const QImage& image, int blockIndex )
+{
+	const auto block = QRect( blockIndex % m_columns * BlockSize, blockIndex / m_columns * BlockSize,
+							  BlockSize, BlockSize ).intersected( image.rect() );
+
+	quint32 lanes[BlockSize];
+	std::fill( lanes, lanes + BlockSize, HashSeed );
+
+	const auto source = image.constBits() + block.top() * image.bytesPerLine() + block.left() * 4;
+
+	if( block.width() == BlockSize )
+	{
+		hashRows( lanes, source, image.bytesPerLine(), block.height() );
+	}
+	else
+	{
+		hashRowsGeneric( lanes, source, image.bytesPerLine(), block.width(), block.height() );
+	}
+
+	// FNV-1a style combination of all lanes
+	quint64 hash = Q_UINT64_C(14695981039346656037);
+	for( auto lane : lanes )
+	{
+		hash = ( hash ^ lane ) * Q_UINT64_C(1099511628211);
+	}
+
+	if( m_blockHashes[blockIndex] == hash )
+	{
+		return 0;
+	}
+
+	m_blockHashes[blockIndex] = hash;
+
+	return block.width() * block.height();
+}
+
+
+
+void FramebufferActivityDetector::recordChange( double changedFraction )
+{
+	QMutexLocker locker( &m_mutex );
+
+	const auto now = m_clock.elapsed();
+
+	m_activity = decayedActivity( now ) + changedFraction;
+	m_lastChange = now;
+}
+
+
+
+double FramebufferActivityDetector::decayedActivity( qint64 now ) const
+{
+	return m_activity * qExp( -double( now - m_lastChange ) / TimeConstant );
+}
+
+
+
+int FramebufferActivityDetector::activityLevel( qint64 now ) const
+{
+	// the decayed sum approximates the changed fraction per second multiplied by the time constant in seconds
+	return qMin( 1000, qRound( decayedActivity( now ) * 1000 * 1000 / TimeConstant ) );
+}
@@ -0,0 +1,251 @@
+/*
+ * FramebufferPool.cpp - implementation of FramebufferPool class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QMutexLocker>
+
+#include <cstdlib>
+
+#ifdef Q_OS_LINUX
+#include <sys/mman.h>
+#endif
+
+#ifdef Q_OS_WIN
+#include <malloc.h>
+#endif
+
+#include "FramebufferPool.h"
+
+
+FramebufferPool& FramebufferPool::instance()
+{
+	static FramebufferPool pool;
+	return pool;
+}
+
+
+
+FramebufferPool::FramebufferPool() :
+	m_mutex(),
+	m_freeBuffers(),
+	m_usedBuffers(),
+	m_statistics( { 0, 0, 0, 0 } )
+{
+}
+
+
+
+FramebufferPool::~FramebufferPool()
+{
+	for( auto it = m_freeBuffers.constBegin(), end = m_freeBuffers.constEnd(); it != end; ++it )
+	{
+		for( auto buffer : it.value() )
+		{
+			freeAligned( buffer, it.key() );
+		}
+	}
+}
+
+
+
+void* FramebufferPool::allocate( size_t size )
+{
+	const auto bufferSize = sizeClass( size );
+
+	QMutexLocker locker( &m_mutex );
+
+	void* buffer = nullptr;
+
+	auto it = m_freeBuffers.find( bufferSize );
+	if( it != m_freeBuffers.end() && it->isEmpty() == false )
+	{
+		buffer = it->takeLast();
+		m_statistics.bytesPooled -= static_cast<qint64>( bufferSize );
+		++m_statistics.reuseCount;
+	}
+	else
+	{
+		buffer = allocateAligned( bufferSize );
+		if( buffer == nullptr )
+		{
+			qCritical() << "FramebufferPool::allocate(): failed to allocate" << bufferSize << "bytes";
+			return nullptr;
+		}
+		++m_statistics.allocationCount;
+	}
+
+	m_usedBuffers[buffer] = bufferSize;
+	m_statistics.bytesInUse += static_cast<qint64>( bufferSize );
+
+	return buffer;
+}
+
+
+
+void FramebufferPool::release( void* buffer )
+{
+	if( buffer == nullptr )
+	{
+		return;
+	}
+
+	QMutexLocker locker( &m_mutex );
+
+	auto it = m_usedBuffers.find( buffer );
+	if( it == m_usedBuffers.end() )
+	{
+		qCritical( "FramebufferPool::release(): buffer not allocated by pool" );
+		return;
+	}
+
+	const auto bufferSize = it.value();
+	m_usedBuffers.erase( it );
+	m_statistics.bytesInUse -= static_cast<qint64>( bufferSize );
+
+	if( m_statistics.bytesPooled + static_cast<qint64>( bufferSize ) > MaximumPooledSize )
+	{
+		freeAligned( buffer, bufferSize );
+		return;
+	}
+
+	m_freeBuffers[bufferSize].append( buffer );
+	m_statistics.bytesPooled += static_cast<qint64>( bufferSize );
+}
+
+
+
+FramebufferPool::Statistics FramebufferPool::statistics() const
+{
+	QMutexLocker locker( &m_mutex );
+	return m_statistics;
+}
+
+
+
+QJsonObject FramebufferPool::statisticsToJson() const
+{
+	const auto currentStatistics = statistics();
+
+	return QJsonObject( {
+							{ QStringLiteral("allocationCount"), static_cast<qint64>( currentStatistics.allocationCount ) },
+							{ QStringLiteral("reuseCount"), static_cast<qint64>( currentStatistics.reuseCount ) },
+							{ QStringLiteral("bytesInUse"), currentStatistics.bytesInUse },
+							{ QStringLiteral("bytesPooled"), currentStatistics.bytesPooled }
+						} );
+}
+
+
+
+size_t FramebufferPool::sizeClass( size_t size )
+{
+	if( size <= static_cast<size_t>( MinimumSizeClass ) )
+	{
+		return MinimumSizeClass;
+	}
+
+	// determine largest power of two below size and round up to next quarter of it
+	size_t powerOfTwo = MinimumSizeClass;
+	while( powerOfTwo * 2 < size )
+	{
+		powerOfTwo *= 2;
+	}
+
+	const auto step = powerOfTwo / 4;
+
+	return ( size + step - 1 ) / step * step;
+}
+
+
+
+void* FramebufferPool::allocateAligned( size_t size )
+{
+	if( size < static_cast<size_t>( HugePageSize ) )
+	{
+#ifdef Q_OS_WIN
+		return _aligned_malloc( size, SmallBufferAlignment );
+#else
+		void* buffer = nullptr;
+		return posix_memalign( &buffer, SmallBufferAlignment, size ) == 0 ? buffer : nullptr;
+#endif
+	}
+
+#if defined(Q_OS_LINUX)
+	// map one huge page more than needed and unmap the unaligned head and the remaining tail
+	// afterwards so huge page alignment does not waste any memory (size classes of this size
+	// are multiples of the page size)
+	const auto mappedSize = size + HugePageSize;
+	auto mapping = mmap( nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+	if( mapping == MAP_FAILED )
+	{
+		return nullptr;
+	}
+
+	const auto address = reinterpret_cast<quintptr>( mapping );
+	const auto alignedAddress = ( address + HugePageSize - 1 ) & ~static_cast<quintptr>( HugePageSize - 1 );
+	const auto headSize = alignedAddress - address;
+	const auto tailSize = mappedSize - headSize - size;
+
+	if( headSize > 0 )
+	{
+		munmap( mapping, headSize );
+	}
+	if( tailSize > 0 )
+	{
+		munmap( reinterpret_cast<void *>( alignedAddress + size ), tailSize );
+	}
+
+	auto buffer = reinterpret_cast<void *>( alignedAddress );
+
+#ifdef MADV_HUGEPAGE
+	madvise( buffer, size, MADV_HUGEPAGE );
+#endif
+
+	return buffer;
+#elif defined(Q_OS_WIN)
+	return _aligned_malloc( size, HugePageSize );
+#else
+	void* buffer = nullptr;
+	return posix_memalign( &buffer, HugePageSize, size ) == 0 ? buffer : nullptr;
+#endif
+}
+
+
+
+void FramebufferPool::freeAligned( void* buffer, size_t size )
+{
+#if defined(Q_OS_LINUX)
+	if( size >= static_cast<size_t>( HugePageSize ) )
+	{
+		munmap( buffer, size );
+		return;
+	}
+#else
+	Q_UNUSED(size)
+#endif
+
+#ifdef Q_OS_WIN
+	_aligned_free( buffer );
+#else
+	free( buffer );
+#endif
+}
@@ -0,0 +1,376 @@
+/*
+ * FramebufferScaler.cpp - implementation of FramebufferScaler class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QVector>
+
+#include "FramebufferScaler.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#if defined(__SSE2__) || defined(_M_X64)
+#define FRAMEBUFFER_SCALER_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__)
+#define FRAMEBUFFER_SCALER_AVX2
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define FRAMEBUFFER_SCALER_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// 16 bit accumulators can hold the sum of up to 257 rows of 8 bit values
+static constexpr int MaximumBoxHeight = 65535 / 255;
+
+using AccumulateRowFunction = void (*)( quint16* accumulator, const quint8* source, int count );
+
+
+static void accumulateRowGeneric( quint16* accumulator, const quint8* source, int count )
+{
+	for( int i = 0; i < count; ++i )
+	{
+		accumulator[i] += source[i];
+	}
+}
+
+
+#ifdef FRAMEBUFFER_SCALER_SSE2
+static void accumulateRowSse2( quint16* accumulator, const quint8* source, int count )
+{
+	const auto zero = _mm_setzero_si128();
+
+	int i = 0;
+	for( ; i + 16 <= count; i += 16 )
+	{
+		const auto data = _mm_loadu_si128( reinterpret_cast<const __m128i *>( source + i ) );
+		auto accumulatorLow = reinterpret_cast<__m128i *>( accumulator + i );
+		auto accumulatorHigh = reinterpret_cast<__m128i *>( accumulator + i + 8 );
+
+		_mm_storeu_si128( accumulatorLow, _mm_add_epi16( _mm_loadu_si128( accumulatorLow ), _mm_unpacklo_epi8( data, zero ) ) );
+		_mm_storeu_si128( accumulatorHigh, _mm_add_epi16( _mm_loadu_si128( accumulatorHigh ), _mm_unpackhi_epi8( data, zero ) ) );
+	}
+
+	accumulateRowGeneric( accumulator + i, source + i, count - i );
+}
+#endif
+
+
+#ifdef FRAMEBUFFER_SCALER_AVX2
+__attribute__((target("avx2")))
+static void accumulateRowAvx2( quint16* accumulator, const quint8* source, int count )
+{
+	int i = 0;
+	for( ; i + 32 <= count; i += 32 )
+	{
+		const auto data = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( source + i ) );
+		auto accumulatorLow = reinterpret_cast<__m256i *>( accumulator + i );
+		auto accumulatorHigh = reinterpret_cast<__m256i *>( accumulator + i + 16 );
+
+		_mm256_storeu_si256( accumulatorLow, _mm256_add_epi16( _mm256_loadu_si256( accumulatorLow ),
+															   _mm256_cvtepu8_epi16( _mm256_castsi256_si128( data ) ) ) );
+		_mm256_storeu_si256( accumulatorHigh, _mm256_add_epi16( _mm256_loadu_si256( accumulatorHigh ),
+																_mm256_cvtepu8_epi16( _mm256_extracti128_si256( data, 1 ) ) ) );
+	}
+
+	accumulateRowGeneric( accumulator + i, source + i, count - i );
+}
+#endif
+
+
+#ifdef FRAMEBUFFER_SCALER_NEON
+static void accumulateRowNeon( quint16* accumulator, const quint8* source, int count )
+{
+	int i = 0;
+	for( ; i + 16 <= count; i += 16 )
+	{
+		const auto data = vld1q_u8( source + i );
+		vst1q_u16( accumulator + i, vaddw_u8( vld1q_u16( accumulator + i ), vget_low_u8( data ) ) );
+		vst1q_u16( accumulator + i + 8, vaddw_u8( vld1q_u16( accumulator + i + 8 ), vget_high_u8( data ) ) );
+	}
+
+	accumulateRowGeneric( accumulator + i, source + i, count - i );
+}
+#endif
+
+
+static AccumulateRowFunction kernelFunction( FramebufferScaler::Kernel kernel )
+{
+	switch( kernel )
+	{
+	case FramebufferScaler::GenericKernel:
+		return accumulateRowGeneric;
+#ifdef FRAMEBUFFER_SCALER_SSE2
+	case FramebufferScaler::Sse2Kernel:
+		return accumulateRowSse2;
+#endif
+#ifdef FRAMEBUFFER_SCALER_AVX2
+	case FramebufferScaler::Avx2Kernel:
+		__builtin_cpu_init();
+		return __builtin_cpu_supports( "avx2" ) ? accumulateRowAvx2 : nullptr;
+#endif
+#ifdef FRAMEBUFFER_SCALER_NEON
+	case FramebufferScaler::NeonKernel:
+		return accumulateRowNeon;
+#endif
+	default:
+		break;
+	}
+
+	return nullptr;
+}
+
+
+static AccumulateRowFunction selectAccumulateRowFunction()
+{
+#ifdef FRAMEBUFFER_SCALER_AVX2
+	__builtin_cpu_init();
+	if( __builtin_cpu_supports( "avx2" ) )
+	{
+		return accumulateRowAvx2;
+	}
+#endif
+#ifdef FRAMEBUFFER_SCALER_SSE2
+	return accumulateRowSse2;
+#elif defined(FRAMEBUFFER_SCALER_NEON)
+	return accumulateRowNeon;
+#else
+	return accumulateRowGeneric;
+#endif
+}
+
+
+static AccumulateRowFunction accumulateRow = selectAccumulateRowFunction();
+
+
+// sums up the accumulated columns of one target pixel and stores the average
+static inline quint32 averagePixel( const quint16* accumulator, int columns, float factor )
+{
+#ifdef FRAMEBUFFER_SCALER_SSE2
+	const auto zero = _mm_setzero_si128();
+	auto sum = _mm_setzero_si128();
+	for( int x = 0; x < columns; ++x )
+	{
+		sum = _mm_add_epi32( sum, _mm_unpacklo_epi16( _mm_loadl_epi64( reinterpret_cast<const __m128i *>( accumulator + x * 4 ) ), zero ) );
+	}
+
+	const auto average = _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( _mm_cvtepi32_ps( sum ), _mm_set1_ps( factor ) ),
+													   _mm_set1_ps( 0.5f ) ) );
+	const auto packed = _mm_packs_epi32( average, average );
+	return static_cast<quint32>( _mm_cvtsi128_si32( _mm_packus_epi16( packed, packed ) ) );
+#else
+	quint32 sum[4] = { 0, 0, 0, 0 };
+	for( int x = 0; x < columns; ++x )
+	{
+		sum[0] += accumulator[x*4+0];
+		sum[1] += accumulator[x*4+1];
+		sum[2] += accumulator[x*4+2];
+		sum[3] += accumulator[x*4+3];
+	}
+
+	quint32 pixel;
+	auto bytes = reinterpret_cast<quint8 *>( &pixel );
+	for( int c = 0; c < 4; ++c )
+	{
+		bytes[c] = static_cast<quint8>( qMin<quint32>( 255, static_cast<quint32>( sum[c] * factor + 0.5f ) ) );
+	}
+	return pixel;
+#endif
+}
+
+
+// fallback for extreme reductions where 16 bit accumulators would overflow
+static quint32 averagePixelGeneric( const quint8* source, int stride, int columns, int rows )
+{
+	quint32 sum[4] = { 0, 0, 0, 0 };
+	for( int y = 0; y < rows; ++y )
+	{
+		const auto line = source + y * stride;
+		for( int x = 0; x < columns * 4; x += 4 )
+		{
+			sum[0] += line[x+0];
+			sum[1] += line[x+1];
+			sum[2] += line[x+2];
+			sum[3] += line[x+3];
+		}
+	}
+
+	const auto area = static_cast<quint32>( columns * rows );
+
+	quint32 pixel;
+	auto bytes = reinterpret_cast<quint8 *>( &pixel );
+	for( int c = 0; c < 4; ++c )
+	{
+		bytes[c] = static_cast<quint8>( ( sum[c] + area / 2 ) / area );
+	}
+	return pixel;
+}
+
+
+static void scaleArea( const quint8* source, int sourceStride, int sourceWidth, int sourceHeight,
+					   quint8* target, int targetStride, int targetWidth, int targetHeight,
+					   int left, int top, int right, int bottom )
+{
+	// source column range covered by each target column
+	QVector<int> columnStart( right - left + 1 );
+	for( int x = left; x <= right; ++x )
+	{
+		columnStart[x-left] = x * sourceWidth / targetWidth;
+	}
+
+	const auto sourceLeft = columnStart.first();
+	const auto sourceColumns = columnStart.last() - sourceLeft;
+
+	QVector<quint16> accumulator( sourceColumns * 4 );
+
+	for( int y = top; y < bottom; ++y )
+	{
+		const auto sourceTop = y * sourceHeight / targetHeight;
+		const auto rows = ( y + 1 ) * sourceHeight / targetHeight - sourceTop;
+		const auto sourceLine = source + sourceTop * sourceStride + sourceLeft * 4;
+		auto targetLine = reinterpret_cast<quint32 *>( target + y * targetStride );
+
+		if( rows > MaximumBoxHeight )
+		{
+			for( int x = left; x < right; ++x )
+			{
+				targetLine[x] = averagePixelGeneric( source + sourceTop * sourceStride + columnStart[x-left] * 4, sourceStride,
+													 columnStart[x-left+1] - columnStart[x-left], rows );
+			}
+			continue;
+		}
+
+		// vertical pass: sum up all rows covered by current target row
+		accumulator.fill( 0 );
+		for( int row = 0; row < rows; ++row )
+		{
+			accumulateRow( accumulator.data(), sourceLine + row * sourceStride, sourceColumns * 4 );
+		}
+
+		// horizontal pass: sum up columns covered by each target pixel and normalize
+		for( int x = left; x < right; ++x )
+		{
+			const auto columns = columnStart[x-left+1] - columnStart[x-left];
+			targetLine[x] = averagePixel( accumulator.constData() + ( columnStart[x-left] - sourceLeft ) * 4,
+										  columns, 1.0f / static_cast<float>( columns * rows ) );
+		}
+	}
+}
+
+}
+
+
+
+bool FramebufferScaler::canScale( const QImage& source, QSize targetSize )
+{
+	return ( source.format() == QImage::Format_RGB32 ||
+			 source.format() == QImage::Format_ARGB32_Premultiplied ) &&
+			targetSize.isEmpty() == false &&
+			targetSize.width() <= source.width() &&
+			targetSize.height() <= source.height();
+}
+
+
+
+QImage FramebufferScaler::scaled( const QImage& source, QSize targetSize )
+{
+	if( canScale( source, targetSize ) == false )
+	{
+		return source.scaled( targetSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
+	}
+
+	QImage target( targetSize, source.format() );
+	scale( source, target, target.rect() );
+
+	return target;
+}
+
+
+
+bool FramebufferScaler::scale( const QImage& source, QImage& target, const QRect& targetArea )
+{
+	if( canScale( source, target.size() ) == false || target.format() != source.format() )
+	{
+		return false;
+	}
+
+	const auto area = targetArea.intersected( target.rect() );
+	if( area.isEmpty() )
+	{
+		return true;
+	}
+
+	scaleArea( source.constBits(), source.bytesPerLine(), source.width(), source.height(),
+			   target.bits(), target.bytesPerLine(), target.width(), target.height(),
+			   area.left(), area.top(), area.right() + 1, area.bottom() + 1 );
+
+	return true;
+}
+
+
+
+bool FramebufferScaler::isKernelSupported( Kernel kernel )
+{
+	return kernelFunction( kernel ) != nullptr;
+}
+
+
+
+bool FramebufferScaler::setKernel( Kernel kernel )
+{
+	const auto function = kernelFunction( kernel );
+	if( function == nullptr )
+	{
+		return false;
+	}
+
+	accumulateRow = function;
+
+	return true;
+}
+
+
+
+void FramebufferScaler::resetKernel()
+{
+	accumulateRow = selectAccumulateRowFunction();
+}
+
+
+
+QRect FramebufferScaler::mapToTarget( const QRect& sourceArea, QSize sourceSize, QSize targetSize )
+{
+	if( sourceSize.isEmpty() || targetSize.isEmpty() )
+	{
+		return QRect();
+	}
+
+	const auto left = sourceArea.left() * targetSize.width() / sourceSize.width();
+	const auto top = sourceArea.top() * targetSize.height() / sourceSize.height();
+	const auto right = ( ( sourceArea.right() + 1 ) * targetSize.width() + sourceSize.width() - 1 ) / sourceSize.width();
+	const auto bottom = ( ( sourceArea.bottom() + 1 ) * targetSize.height() + sourceSize.height() - 1 ) / sourceSize.height();
+
+	return QRect( left, top, right - left, bottom - top ).intersected( QRect( QPoint( 0, 0 ), targetSize ) );
+}
@@ -0,0 +1,299 @@
+/*
+ * HostProber.cpp - implementation of HostProber class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QMutexLocker>
+#include <QTcpSocket>
+#include <QtEndian>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "HostProber.h"
+#include "HostResolver.h"
+
+#ifdef Q_OS_LINUX
+namespace {
+
+struct IcmpEchoHeader
+{
+	quint8 type;
+	quint8 code;
+	quint16 checksum;
+	quint16 identifier;
+	quint16 sequence;
+};
+
+enum {
+	IcmpEchoReply = 0,
+	IcmpEchoRequest = 8,
+};
+
+}
+#endif
+
+
+
+HostProber::HostProber() :
+	m_mutex(),
+	m_probesUpdated(),
+	m_cache(),
+	m_pendingProbes(),
+	m_icmpSocket( -1 ),
+	m_icmpSequence( 0 ),
+	m_receiving( false )
+{
+#ifdef Q_OS_LINUX
+	m_icmpSocket = socket( AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_ICMP );
+	if( m_icmpSocket < 0 )
+	{
+		qDebug( "HostProber: ICMP datagram sockets not available, using TCP probes" );
+	}
+#endif
+}
+
+
+
+HostProber::~HostProber()
+{
+#ifdef Q_OS_LINUX
+	if( m_icmpSocket >= 0 )
+	{
+		close( m_icmpSocket );
+	}
+#endif
+}
+
+
+
+bool HostProber::isReachable( const QString& host, int port )
+{
+	m_mutex.lock();
+	const auto cacheEntry = m_cache.value( host );
+	m_mutex.unlock();
+
+	if( cacheEntry.age.isValid() && cacheEntry.age.elapsed() < CacheLifetime )
+	{
+		return cacheEntry.reachable;
+	}
+
+	const auto address = resolve( host );
+	if( address.isNull() )
+	{
+		return false;
+	}
+
+	auto result = probeIcmp( address );
+	if( result == ProbeFailed )
+	{
+		result = probeTcp( address, port );
+	}
+
+	if( result == ProbeFailed )
+	{
+		return false;
+	}
+
+	QMutexLocker locker( &m_mutex );
+	auto& entry = m_cache[host];
+	entry.reachable = result == HostReachable;
+	entry.age.start();
+
+	return entry.reachable;
+}
+
+
+
+QHostAddress HostProber::resolve( const QString& host )
+{
+	QHostAddress address( host );
+	if( address.isNull() == false )
+	{
+		return address;
+	}
+
+	// prefer IPv4 addresses as they can be probed via ICMP
+	return HostResolver::preferredAddress( VeyonCore::hostResolver().resolve( host ) );
+}
+
+
+
+HostProber::ProbeResult HostProber::probeIcmp( const QHostAddress& address )
+{
+	if( m_icmpSocket < 0 || address.protocol() != QAbstractSocket::IPv4Protocol )
+	{
+		return ProbeFailed;
+	}
+
+	const auto ipv4Address = address.toIPv4Address();
+
+	QMutexLocker locker( &m_mutex );
+
+	// join probe of other thread for the same address if any
+	auto probe = m_pendingProbes.value( ipv4Address );
+	if( probe == nullptr )
+	{
+		const auto sequence = ++m_icmpSequence;
+		if( sendEchoRequest( ipv4Address, sequence ) == false )
+		{
+			return ProbeFailed;
+		}
+
+		probe = new Probe{ sequence, false, 0 };
+		m_pendingProbes[ipv4Address] = probe;
+	}
+
+	++probe->waiterCount;
+
+	QElapsedTimer probeTimer;
+	probeTimer.start();
+
+	while( probe->finished == false && probeTimer.elapsed() < IcmpProbeTimeout )
+	{
+		const auto remainingTime = static_cast<int>( IcmpProbeTimeout - probeTimer.elapsed() );
+
+		if( m_receiving )
+		{
+			// another thread is receiving replies and will notify us
+			m_probesUpdated.wait( &m_mutex, static_cast<unsigned long>( remainingTime ) );
+		}
+		else
+		{
+			m_receiving = true;
+			locker.unlock();
+
+			receiveEchoReplies( qMin<int>( remainingTime, ReceiveInterval ) );
+
+			locker.relock();
+			m_receiving = false;
+
+			// wake up other waiters so they can check their probes or take over receiving
+			m_probesUpdated.wakeAll();
+		}
+	}
+
+	const auto result = probe->finished ? HostReachable : HostUnreachable;
+
+	if( --probe->waiterCount <= 0 )
+	{
+		m_pendingProbes.remove( ipv4Address );
+		delete probe;
+	}
+
+	return result;
+}
+
+
+
+HostProber::ProbeResult HostProber::probeTcp( const QHostAddress& address, int port )
+{
+	if( port <= 0 )
+	{
+		return ProbeFailed;
+	}
+
+	QTcpSocket socket;
+	socket.connectToHost( address, static_cast<quint16>( port ) );
+
+	if( socket.waitForConnected( TcpProbeTimeout ) ||
+			socket.error() == QTcpSocket::ConnectionRefusedError )
+	{
+		return HostReachable;
+	}
+
+	return HostUnreachable;
+}
+
+
+
+bool HostProber::sendEchoRequest( quint32 address, quint16 sequence )
+{
+#ifdef Q_OS_LINUX
+	// identifier and checksum are filled in by the kernel for ICMP datagram sockets
+	IcmpEchoHeader request{ IcmpEchoRequest, 0, 0, 0, qToBigEndian( sequence ) };
+
+	sockaddr_in target{};
+	target.sin_family = AF_INET;
+	target.sin_addr.s_addr = qToBigEndian( address );
+
+	if( sendto( m_icmpSocket, &request, sizeof(request), 0,
+				reinterpret_cast<sockaddr *>( &target ), sizeof(target) ) == static_cast<ssize_t>( sizeof(request) ) )
+	{
+		return true;
+	}
+
+	qDebug() << "HostProber::sendEchoRequest(): failed to send echo request to"
+			 << QHostAddress( address ).toString() << "with error" << errno;
+#else
+	Q_UNUSED(address)
+	Q_UNUSED(sequence)
+#endif
+
+	return false;
+}
+
+
+
+void HostProber::receiveEchoReplies( int timeout )
+{
+#ifdef Q_OS_LINUX
+	pollfd pollFd{ m_icmpSocket, POLLIN, 0 };
+	if( poll( &pollFd, 1, timeout ) <= 0 )
+	{
+		return;
+	}
+
+	// read all available replies at once
+	forever
+	{
+		IcmpEchoHeader reply{};
+		sockaddr_in source{};
+		socklen_t sourceLength = sizeof(source);
+
+		if( recvfrom( m_icmpSocket, &reply, sizeof(reply), 0,
+					  reinterpret_cast<sockaddr *>( &source ), &sourceLength ) < static_cast<ssize_t>( sizeof(reply) ) )
+		{
+			break;
+		}
+
+		if( reply.type != IcmpEchoReply )
+		{
+			continue;
+		}
+
+		QMutexLocker locker( &m_mutex );
+		auto probe = m_pendingProbes.value( qFromBigEndian<quint32>( source.sin_addr.s_addr ) );
+		if( probe && probe->sequence == qFromBigEndian( reply.sequence ) )
+		{
+			probe->finished = true;
+		}
+	}
+#else
+	Q_UNUSED(timeout)
+#endif
+}
@@ -0,0 +1,171 @@
+/*
+ * HostResolver.cpp - implementation of HostResolver class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QHostInfo>
+#include <QMutexLocker>
+#include <QtConcurrent>
+
+#include "HostResolver.h"
+
+
+HostResolver::HostResolver() :
+	m_mutex(),
+	m_lookupFinished(),
+	m_cache(),
+	m_threadPool()
+{
+	m_threadPool.setMaxThreadCount( MaximumConcurrentLookups );
+}
+
+
+
+HostResolver::~HostResolver()
+{
+	m_threadPool.waitForDone();
+}
+
+
+
+bool HostResolver::lookup( const QString& host, AddressList& addresses )
+{
+	const QHostAddress address( host );
+	if( address.isNull() == false )
+	{
+		addresses = { address };
+		return true;
+	}
+
+	QMutexLocker locker( &m_mutex );
+
+	auto it = m_cache.find( host );
+	if( it == m_cache.end() || it->age.isValid() == false )
+	{
+		if( it == m_cache.end() || it->pending == false )
+		{
+			startLookup( host );
+		}
+		return false;
+	}
+
+	if( isExpired( *it ) )
+	{
+		if( it->pending == false )
+		{
+			startLookup( host );
+		}
+
+		// keep using previous addresses while refreshing
+		if( it->addresses.isEmpty() )
+		{
+			return false;
+		}
+	}
+
+	addresses = it->addresses;
+
+	return true;
+}
+
+
+
+HostResolver::AddressList HostResolver::resolve( const QString& host, int timeout )
+{
+	AddressList addresses;
+	if( lookup( host, addresses ) )
+	{
+		return addresses;
+	}
+
+	QElapsedTimer waitTimer;
+	waitTimer.start();
+
+	QMutexLocker locker( &m_mutex );
+
+	// wait for the lookup started by lookup() or any other thread
+	while( m_cache.value( host ).pending && waitTimer.elapsed() < timeout )
+	{
+		m_lookupFinished.wait( &m_mutex, static_cast<unsigned long>( timeout - waitTimer.elapsed() ) );
+	}
+
+	return m_cache.value( host ).addresses;
+}
+
+
+
+void HostResolver::prefetch( const QStringList& hosts )
+{
+	AddressList addresses;
+
+	for( const auto& host : hosts )
+	{
+		lookup( host, addresses );
+	}
+}
+
+
+
+QHostAddress HostResolver::preferredAddress( const AddressList& addresses )
+{
+	for( const auto& address : addresses )
+	{
+		if( address.protocol() == QAbstractSocket::IPv4Protocol )
+		{
+			return address;
+		}
+	}
+
+	return addresses.isEmpty() ? QHostAddress() : addresses.first();
+}
+
+
+
+bool HostResolver::isExpired( const CacheEntry& entry ) const
+{
+	return entry.age.hasExpired( entry.addresses.isEmpty() ? NegativeLifetime : PositiveLifetime );
+}
+
+
+
+void HostResolver::startLookup( const QString& host )
+{
+	m_cache[host].pending = true;
+
+	QtConcurrent::run( &m_threadPool, [this, host]() {
+		finishLookup( host, QHostInfo::fromName( host ).addresses() );
+	} );
+}
+
+
+
+void HostResolver::finishLookup( const QString& host, const AddressList& addresses )
+{
+	QMutexLocker locker( &m_mutex );
+
+	auto& entry = m_cache[host];
+	entry.addresses = addresses;
+	entry.age.start();
+	entry.pending = false;
+
+	m_lookupFinished.wakeAll();
+}
@@ -23,6 +23,7 @@
  */
 
 #include <QTimer>
+#include <QtConcurrent>
 
 #include "VeyonConfiguration.h"
 #include "VeyonCore.h"
@@ -31,9 +32,21 @@
 
 NetworkObjectDirectory::NetworkObjectDirectory( QObject* parent ) :
 	QObject( parent ),
-	m_updateTimer( new QTimer( this ) )
+	m_updateTimer( new QTimer( this ) ),
+	m_fetchWatcher(),
+	m_objects()
 {
-	connect( m_updateTimer, &QTimer::timeout, this, &NetworkObjectDirectory::update );
+	connect( m_updateTimer, &QTimer::timeout, this, &NetworkObjectDirectory::updateInBackground );
+
+	connect( &m_fetchWatcher, &QFutureWatcherBase::finished,
+			 this, [this]() { setObjects( m_fetchWatcher.result() ); } );
+}
+
+
+
+NetworkObjectDirectory::~NetworkObjectDirectory()
+{
+	m_fetchWatcher.waitForFinished();
 }
 
 
@@ -49,3 +62,112 @@ void NetworkObjectDirectory::setUpdateInterval( int interval )
 		m_updateTimer->stop();
 	}
 }
+
+
+
+QList<NetworkObject> NetworkObjectDirectory::objects( const NetworkObject& parent ) const
+{
+	if( parent.type() == NetworkObject::Root )
+	{
+		return m_objects.keys();
+	}
+	else if( parent.type() == NetworkObject::Group &&
+			 m_objects.contains( parent ) )
+	{
+		return m_objects[parent];
+	}
+
+	return QList<NetworkObject>();
+}
+
+
+
+void NetworkObjectDirectory::setObjects( const ObjectMap& objects )
+{
+	const NetworkObject rootObject( NetworkObject::Root );
+
+	for( auto it = objects.constBegin(), end = objects.constEnd(); it != end; ++it )
+	{
+		if( m_objects.contains( it.key() ) == false )
+		{
+			emit objectsAboutToBeInserted( rootObject, m_objects.count(), 1 );
+			m_objects[it.key()] = QList<NetworkObject>();
+			emit objectsInserted();
+		}
+
+		updateGroup( it.key(), it.value() );
+	}
+
+	int index = 0;
+	for( auto it = m_objects.begin(); it != m_objects.end(); ) // clazy:exclude=detaching-member
+	{
+		if( objects.contains( it.key() ) == false )
+		{
+			emit objectsAboutToBeRemoved( rootObject, index, 1 );
+			it = m_objects.erase( it );
+			emit objectsRemoved();
+		}
+		else
+		{
+			++it;
+			++index;
+		}
+	}
+}
+
+
+
+void NetworkObjectDirectory::update()
+{
+	setObjects( fetchObjects() );
+}
+
+
+
+void NetworkObjectDirectory::updateInBackground()
+{
+	// skip if the previous update is still running, e.g. because of a slow LDAP server
+	if( m_fetchWatcher.isRunning() == false )
+	{
+		m_fetchWatcher.setFuture( QtConcurrent::run( this, &NetworkObjectDirectory::fetchObjects ) );
+	}
+}
+
+
+
+void NetworkObjectDirectory::updateGroup( const NetworkObject& groupObject, const QList<NetworkObject>& members )
+{
+	QList<NetworkObject>& groupObjects = m_objects[groupObject]; // clazy:exclude=detaching-member
+
+	for( const auto& member : members )
+	{
+		const auto index = groupObjects.indexOf( member );
+		if( index < 0 )
+		{
+			emit objectsAboutToBeInserted( groupObject, groupObjects.count(), 1 );
+			groupObjects += member; // clazy:exclude=reserve-candidates
+			emit objectsInserted();
+		}
+		else if( groupObjects[index].exactMatch( member ) == false )
+		{
+			groupObjects.replace( index, member );
+			emit objectChanged( groupObject, index );
+		}
+	}
+
+	int index = 0;
+	for( auto it = groupObjects.begin(); it != groupObjects.end(); )
+	{
+		if( members.contains( *it ) == false )
+		{
+			emit objectsAboutToBeRemoved( groupObject, index, 1 );
+			it = groupObjects.erase( it );
+			emit objectsRemoved();
+		}
+		else
+		{
+			++it;
+			++index;
+		}
+	}
+}
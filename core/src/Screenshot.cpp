@@ -37,6 +37,7 @@
 Screenshot::Screenshot( const QString &fileName, QObject* parent ) :
 	QObject( parent ),
 	m_fileName( fileName ),
+	m_caption(),
 	m_image()
 {
 	if( !m_fileName.isEmpty() && QFileInfo( m_fileName ).isFile() )
@@ -61,7 +62,7 @@ void Screenshot::take( ComputerControlInterface::Pointer computerControlInterfac
 	}
 
 	// construct text
-	QString txt = u + "@" + computerControlInterface->computer().hostAddress() + " " +
+	m_caption = u + "@" + computerControlInterface->computer().hostAddress() + " " +
 			QDate( QDate::currentDate() ).toString( Qt::ISODate ) +
 			" " + QTime( QTime::currentTime() ).
 							toString( Qt::ISODate );
@@ -77,6 +78,7 @@ void Screenshot::take( ComputerControlInterface::Pointer computerControlInterfac
 			QMessageBox::critical( nullptr, tr( "Screenshot" ), msg );
 		}
 
+		emit finished();
 		return;
 	}
 
@@ -89,11 +91,33 @@ void Screenshot::take( ComputerControlInterface::Pointer computerControlInterfac
 	m_fileName = dir + QDir::separator() +
 					u.section( '(', 1, 1 ).section( ')', 0, 0 ) + m_fileName;
 
+	// screen may be grabbed asynchronously via a temporary connection
+	connect( computerControlInterface.data(), &ComputerControlInterface::fullResolutionScreenGrabbed,
+			 this, &Screenshot::save );
+
+	computerControlInterface->grabFullResolutionScreen();
+}
+
+
+
+
+void Screenshot::save( const QImage& screen )
+{
+	// only handle the first grab requested by take()
+	sender()->disconnect( this );
+
+	if( screen.isNull() )
+	{
+		qWarning() << "Screenshot::save(): could not grab screen for" << m_fileName;
+		emit finished();
+		return;
+	}
+
 	const int FONT_SIZE = 14;
 	const int RECT_MARGIN = 10;
 	const int RECT_INNER_MARGIN = 5;
 
-	m_image = QImage( computerControlInterface->screen() );
+	m_image = screen;
 
 	QPixmap icon( QStringLiteral( ":/resources/icon16.png" ) );
 
@@ -108,7 +132,7 @@ void Screenshot::take( ComputerControlInterface::Pointer computerControlInterfac
 	const int rx = RECT_MARGIN;
 	const int ry = m_image.height() - RECT_MARGIN - 2 * RECT_INNER_MARGIN - FONT_SIZE;
 	const int rw = RECT_MARGIN + 4 * RECT_INNER_MARGIN +
-					fm.size( Qt::TextSingleLine, txt ).width() + icon.width();
+					fm.size( Qt::TextSingleLine, m_caption ).width() + icon.width();
 	const int rh = 2 * RECT_INNER_MARGIN + FONT_SIZE;
 	const int ix = rx + RECT_INNER_MARGIN + 1;
 	const int iy = ry + RECT_INNER_MARGIN - 2;
@@ -117,9 +141,18 @@ void Screenshot::take( ComputerControlInterface::Pointer computerControlInterfac
 
 	p.fillRect( rx, ry, rw, rh, QColor( 255, 255, 255, 160 ) );
 	p.drawPixmap( ix, iy, icon );
-	p.drawText( tx, ty, txt );
+	p.drawText( tx, ty, m_caption );
+
+	p.end();
+
+	if( m_image.save( m_fileName, "PNG", 50 ) == false )
+	{
+		qCritical() << "Screenshot::save(): could not save screenshot to" << m_fileName;
+		// do not report screenshots which do not exist
+		m_image = QImage();
+	}
 
-	m_image.save( m_fileName, "PNG", 50 );
+	emit finished();
 }
 
 
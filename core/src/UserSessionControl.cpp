@@ -49,11 +49,14 @@ UserSessionControl::UserSessionControl( QObject* parent ) :
 						 QStringLiteral( ":/resources/system-suspend-hibernate.png" ) ),
 	m_features( { m_userSessionInfoFeature, m_userLogoutFeature } ),
 	m_userInfoQueryThread( new QThread ),
-	m_userInfoQueryTimer( new QTimer )
+	m_userInfoQueryTimer( new QTimer ),
+	m_userSessionMonitorTimer( new QTimer( this ) )
 {
 	// initialize user info query timer and thread
 	m_userInfoQueryTimer->moveToThread( m_userInfoQueryThread );
 	connect( m_userInfoQueryThread, &QThread::finished, m_userInfoQueryThread, &QObject::deleteLater );
+
+	connect( m_userSessionMonitorTimer, &QTimer::timeout, this, &UserSessionControl::monitorUserSession );
 }
 
 
@@ -68,7 +71,15 @@ UserSessionControl::~UserSessionControl()
 
 bool UserSessionControl::getUserSessionInfo( const ComputerControlInterfaceList& computerControlInterfaces )
 {
-	return sendFeatureMessage( FeatureMessage( m_userSessionInfoFeature.uid(), GetInfo ),
+	return sendFeatureRequest( FeatureMessage( m_userSessionInfoFeature.uid(), GetInfo ),
+							   computerControlInterfaces );
+}
+
+
+
+bool UserSessionControl::subscribeUserSessionInfo( const ComputerControlInterfaceList& computerControlInterfaces )
+{
+	return sendFeatureRequest( FeatureMessage( m_userSessionInfoFeature.uid(), SubscribeInfo ),
 							   computerControlInterfaces );
 }
 
@@ -104,6 +115,12 @@ bool UserSessionControl::handleFeatureMessage( VeyonMasterInterface& master, con
 	{
 		computerControlInterface->setUser( message.argument( UserName ).toString() );
 
+		// servers not supporting subscriptions reply without this argument
+		if( message.argument( Subscribed ).toBool() )
+		{
+			computerControlInterface->setStateNotificationsSubscribed();
+		}
+
 		return true;
 	}
 
@@ -118,23 +135,23 @@ bool UserSessionControl::handleFeatureMessage( VeyonServerInterface& server, con
 
 	if( m_userSessionInfoFeature.uid() == message.featureUid() )
 	{
-		FeatureMessage reply( message.featureUid(), message.command() );
+		const auto subscribe = message.command() == SubscribeInfo;
 
-		m_userDataLock.lockForRead();
-		if( m_userName.isEmpty() )
+		if( subscribe )
 		{
-			queryUserInformation();
-			reply.addArgument( UserName, QString() );
+			if( m_subscribers.contains( message.ioDevice() ) == false )
+			{
+				m_subscribers.append( message.ioDevice() );
+			}
+
+			// subscribers get notified about changes so watch the session from now on
+			if( m_userSessionMonitorTimer->isActive() == false )
+			{
+				m_userSessionMonitorTimer->start( UserSessionMonitorInterval );
+			}
 		}
-		else
-		{
-			reply.addArgument( UserName, QString( QStringLiteral( "%1 (%2)" ) ).arg( m_userName, m_userFullName ) );
-		}
-		m_userDataLock.unlock();
 
-		char rfbMessageType = rfbVeyonFeatureMessage;
-		message.ioDevice()->write( &rfbMessageType, sizeof(rfbMessageType) );
-		reply.send( message.ioDevice() );
+		sendUserSessionInfo( message.ioDevice(), message.command(), message.requestId(), subscribe );
 
 		return true;
 	}
@@ -148,6 +165,63 @@ bool UserSessionControl::handleFeatureMessage( VeyonServerInterface& server, con
 
 
 
+void UserSessionControl::sendUserSessionInfoToSubscribers()
+{
+	m_subscribers.removeAll( QPointer<QIODevice>() );
+
+	for( const auto& subscriber : qAsConst(m_subscribers) )
+	{
+		sendUserSessionInfo( subscriber, SubscribeInfo, 0, true );
+	}
+}
+
+
+
+void UserSessionControl::sendUserSessionInfo( QIODevice* ioDevice, FeatureMessage::Command command,
+											  FeatureMessage::RequestId requestId, bool subscribed )
+{
+	FeatureMessage reply( m_userSessionInfoFeature.uid(), command );
+	reply.setRequestId( requestId );
+
+	m_userDataLock.lockForRead();
+	if( m_userName.isEmpty() )
+	{
+		queryUserInformation();
+		reply.addArgument( UserName, QString() );
+	}
+	else
+	{
+		reply.addArgument( UserName, QString( QStringLiteral( "%1 (%2)" ) ).arg( m_userName, m_userFullName ) );
+	}
+	m_userDataLock.unlock();
+
+	if( subscribed )
+	{
+		reply.addArgument( Subscribed, true );
+	}
+
+	char rfbMessageType = rfbVeyonFeatureMessage;
+	ioDevice->write( &rfbMessageType, sizeof(rfbMessageType) );
+	reply.send( ioDevice );
+}
+
+
+
+void UserSessionControl::monitorUserSession()
+{
+	m_subscribers.removeAll( QPointer<QIODevice>() );
+
+	if( m_subscribers.isEmpty() )
+	{
+		m_userSessionMonitorTimer->stop();
+		return;
+	}
+
+	queryUserInformation();
+}
+
+
+
 void UserSessionControl::queryUserInformation()
 {
 	if( m_userInfoQueryThread->isRunning() == false )
@@ -159,11 +233,24 @@ void UserSessionControl::queryUserInformation()
 	// due to domain controller queries and timeouts etc.)
 	m_userInfoQueryTimer->singleShot( 0, m_userInfoQueryTimer, [=]() {
 		const auto userName = VeyonCore::platform().userFunctions().currentUser();
+
+		m_userDataLock.lockForRead();
+		const auto userChanged = userName != m_userName;
+		m_userDataLock.unlock();
+
+		if( userChanged == false )
+		{
+			return;
+		}
+
 		const auto userFullName = VeyonCore::platform().userFunctions().fullName( userName );
 		m_userDataLock.lockForWrite();
 		m_userName = userName;
 		m_userFullName = userFullName;
 		m_userDataLock.unlock();
+
+		// notify subscribers from main thread
+		QMetaObject::invokeMethod( this, "sendUserSessionInfoToSubscribers", Qt::QueuedConnection );
 	} );
 }
 
@@ -83,6 +83,13 @@ VeyonConfiguration VeyonConfiguration::defaultConfiguration()
 	c.setScreenshotDirectory( QDir::toNativeSeparators( QStringLiteral( "%APPDATA%/Screenshots" ) ) );
 	c.setComputerMonitoringUpdateInterval( 1000 );
 	c.setComputerMonitoringBackgroundColor( Qt::white );
+	c.setMaximumConcurrentConnectionAttempts( 16 );
+	c.setConnectionAttemptsPerSecond( 25 );
+	c.setMaximumReconnectInterval( 60 );
+	c.setMaximumIngressBandwidth( 0 );
+	c.setAdaptiveConnectionQualityEnabled( true );
+	c.setThumbnailCacheEnabled( true );
+	c.setConnectionStatisticsEnabled( false );
 
 	c.setAuthenticationMethod( VeyonCore::LogonAuthentication );
 
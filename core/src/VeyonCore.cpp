@@ -37,6 +37,8 @@
 
 #include "ComputerControlInterface.h"
 #include "Filesystem.h"
+#include "HostProber.h"
+#include "HostResolver.h"
 #include "Logger.h"
 #include "NetworkObjectDirectoryManager.h"
 #include "PasswordDialog.h"
@@ -46,6 +48,7 @@
 #include "PluginManager.h"
 #include "UserGroupsBackendManager.h"
 #include "VeyonConfiguration.h"
+#include "VncConnectionEngine.h"
 
 
 VeyonCore* VeyonCore::s_instance = nullptr;
@@ -63,6 +66,9 @@ VeyonCore::VeyonCore( QCoreApplication* application, const QString& appComponent
 	m_platformPlugin( nullptr ),
 	m_userGroupsBackendManager( nullptr ),
 	m_networkObjectDirectoryManager( nullptr ),
+	m_vncConnectionEngine( nullptr ),
+	m_hostProber( nullptr ),
+	m_hostResolver( nullptr ),
 	m_localComputerControlInterface( nullptr ),
 	m_applicationName( QStringLiteral( "Veyon" ) ),
 	m_authenticationKeyName()
@@ -96,6 +102,15 @@ VeyonCore::VeyonCore( QCoreApplication* application, const QString& appComponent
 
 VeyonCore::~VeyonCore()
 {
+	delete m_vncConnectionEngine;
+	m_vncConnectionEngine = nullptr;
+
+	delete m_hostProber;
+	m_hostProber = nullptr;
+
+	delete m_hostResolver;
+	m_hostResolver = nullptr;
+
 	delete m_userGroupsBackendManager;
 	m_userGroupsBackendManager = nullptr;
 
@@ -447,6 +462,9 @@ void VeyonCore::initManagers()
 {
 	m_userGroupsBackendManager = new UserGroupsBackendManager( this );
 	m_networkObjectDirectoryManager = new NetworkObjectDirectoryManager( this );
+	m_hostResolver = new HostResolver;
+	m_vncConnectionEngine = new VncConnectionEngine;
+	m_hostProber = new HostProber;
 }
 
 
@@ -22,6 +22,8 @@
  *
  */
 
+#include <QBuffer>
+
 #include "FeatureMessage.h"
 #include "VeyonCoreConnection.h"
 #include "SocketDevice.h"
@@ -36,27 +38,21 @@ extern "C"
 class FeatureMessageEvent : public MessageEvent
 {
 public:
-	FeatureMessageEvent( const FeatureMessage& featureMessage ) :
-		m_featureMessage( featureMessage )
+	FeatureMessageEvent( const QByteArray& encodedMessage ) :
+		m_encodedMessage( encodedMessage )
 	{
 	}
 
 	void fire( rfbClient* client ) override
 	{
-		qDebug() << "FeatureMessageEvent::fire(): sending message" << m_featureMessage.featureUid()
-				 << "command" << m_featureMessage.command()
-				 << "arguments" << m_featureMessage.arguments();
-
 		SocketDevice socketDevice( VeyonVncConnection::libvncClientDispatcher, client );
-		char messageType = rfbVeyonFeatureMessage;
-		socketDevice.write( &messageType, sizeof(messageType) );
-
-		m_featureMessage.send( &socketDevice );
+		socketDevice.write( m_encodedMessage.constData(), m_encodedMessage.size() );
 	}
 
 
 private:
-	FeatureMessage m_featureMessage;
+	// implicitly shared with all other connections the message is sent to
+	const QByteArray m_encodedMessage;
 
 } ;
 
@@ -106,7 +102,39 @@ void VeyonCoreConnection::sendFeatureMessage( const FeatureMessage& featureMessa
 		return;
 	}
 
-	m_vncConn->enqueueEvent( new FeatureMessageEvent( featureMessage ) );
+	qDebug() << "VeyonCoreConnection::sendFeatureMessage(): sending message" << featureMessage.featureUid()
+			 << "command" << featureMessage.command()
+			 << "arguments" << featureMessage.arguments();
+
+	sendEncodedFeatureMessage( encodeFeatureMessage( featureMessage ) );
+}
+
+
+
+void VeyonCoreConnection::sendEncodedFeatureMessage( const QByteArray& encodedMessage )
+{
+	if( m_vncConn == nullptr )
+	{
+		qCritical( "VeyonCoreConnection::sendEncodedFeatureMessage(): cannot call enqueueEvent - m_vncConn is NULL" );
+		return;
+	}
+
+	m_vncConn->enqueueEvent( new FeatureMessageEvent( encodedMessage ) );
+}
+
+
+
+QByteArray VeyonCoreConnection::encodeFeatureMessage( const FeatureMessage& featureMessage )
+{
+	QBuffer buffer;
+	buffer.open( QBuffer::WriteOnly );
+
+	const char messageType = rfbVeyonFeatureMessage;
+	buffer.write( &messageType, sizeof(messageType) );
+
+	featureMessage.send( &buffer );
+
+	return buffer.data();
 }
 
 
@@ -154,7 +182,7 @@ bool VeyonCoreConnection::handleServerMessage( rfbClient* client, uint8_t msg )
 
 		return true;
 	}
-	else
+	else if( msg != rfbVeyonScaledFramebuffer )
 	{
 		qCritical( "VeyonCoreConnection::handleServerMessage(): "
 				"unknown message type %d from server. Closing "
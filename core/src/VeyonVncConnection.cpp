@@ -31,13 +31,22 @@
 #include <QMutexLocker>
 #include <QPixmap>
 #include <QTime>
+#include <QtEndian>
+#include <QtConcurrentRun>
+
+#include <random>
 
 #include "AuthenticationCredentials.h"
 #include "CryptoCore.h"
-#include "PlatformNetworkFunctions.h"
+#include "FramebufferPool.h"
+#include "FramebufferScaler.h"
+#include "HostProber.h"
+#include "HostResolver.h"
 #include "PlatformUserFunctions.h"
 #include "VeyonConfiguration.h"
+#include "VeyonRfbExt.h"
 #include "VeyonVncConnection.h"
+#include "VncConnectionEngine.h"
 #include "SocketDevice.h"
 #include "VariantArrayMessage.h"
 
@@ -48,66 +57,50 @@ extern "C"
 
 // clazy:excludeall=copyable-polymorphic
 
-class KeyClientEvent : public MessageEvent
+class ClientCutEvent : public MessageEvent
 {
 public:
-	KeyClientEvent( unsigned int key, bool pressed ) :
-		m_key( key ),
-		m_pressed( pressed )
+	ClientCutEvent( const QString& text ) :
+		m_text( text.toUtf8() )
 	{
 	}
 
 	void fire( rfbClient *cl ) override
 	{
-		SendKeyEvent( cl, m_key, m_pressed );
+		SendClientCutText( cl, m_text.data(), m_text.size() ); // clazy:exclude=detaching-member
 	}
 
 private:
-	unsigned int m_key;
-	bool m_pressed;
+	QByteArray m_text;
 } ;
 
 
 
-class PointerClientEvent : public MessageEvent
+class SetScaledSizeEvent : public MessageEvent
 {
 public:
-	PointerClientEvent( int x, int y, int buttonMask ) :
-		m_x( x ),
-		m_y( y ),
-		m_buttonMask( buttonMask )
+	SetScaledSizeEvent( QSize size ) :
+		m_size( size )
 	{
 	}
 
 	void fire( rfbClient *cl ) override
 	{
-		SendPointerEvent( cl, m_x, m_y, m_buttonMask );
+		VeyonVncConnection::sendScaledSize( cl, m_size );
 	}
 
 private:
-	int m_x;
-	int m_y;
-	int m_buttonMask;
+	QSize m_size;
 } ;
 
 
 
-class ClientCutEvent : public MessageEvent
-{
-public:
-	ClientCutEvent( const QString& text ) :
-		m_text( text.toUtf8() )
-	{
-	}
-
-	void fire( rfbClient *cl ) override
-	{
-		SendClientCutText( cl, m_text.data(), m_text.size() ); // clazy:exclude=detaching-member
-	}
+static rfbClientProtocolExtension* __veyonScaledFramebufferExt = nullptr;
 
-private:
-	QByteArray m_text;
-} ;
+// libvncclient announces the encodings of registered extensions on every connection, so the
+// pseudo-encoding is only filled in while a thumbnail connection is sending its encodings
+static QMutex __veyonScaledFramebufferEncodingsLock;
+static int __veyonScaledFramebufferEncodings[] = { 0, 0 };
 
 
 
@@ -117,12 +110,22 @@ rfbBool VeyonVncConnection::hookInitFrameBuffer( rfbClient* client )
 {
 	auto connection = static_cast<VeyonVncConnection *>( rfbClientGetClientData( client, nullptr ) );
 
+	// not resized but called by rfbInitClient() right before sending the encodings?
+	const auto initializing = connection->m_framebufferState == FramebufferInvalid;
+
 	const auto size = static_cast<uint64_t>( client->width * client->height * ( client->format.bitsPerPixel / 8 ) );
 
-	client->frameBuffer = new uint8_t[size];
+	client->frameBuffer = static_cast<uint8_t *>( FramebufferPool::instance().allocate( size ) );
+	if( client->frameBuffer == nullptr )
+	{
+		return false;
+	}
 
 	memset( client->frameBuffer, '\0', size );
 
+	connection->m_framebufferInitTimer.start();
+	connection->m_activityDetector.reset();
+
 	// initialize framebuffer image which just wraps the allocated memory and ensures cleanup after last
 	// image copy using the framebuffer gets destroyed
 	connection->m_imgLock.lockForWrite();
@@ -139,36 +142,18 @@ rfbBool VeyonVncConnection::hookInitFrameBuffer( rfbClient* client )
 	client->format.blueMax = 0xff;
 
 	client->appData.useRemoteCursor = false;
-	client->appData.compressLevel = 0;
 	client->appData.useBGR233 = false;
-	client->appData.qualityLevel = 9;
-	client->appData.enableJPEG = false;
 
-	switch( connection->quality() )
-	{
-	case ScreenshotQuality:
-		client->appData.encodingsString = "raw";
-		break;
-	case RemoteControlQuality:
-		client->appData.encodingsString = "copyrect hextile raw";
-		//cl->appData.useRemoteCursor = true;
-		break;
-	case ThumbnailQuality:
-		client->appData.encodingsString = "zrle ultra "
-										  "copyrect hextile zlib "
-										  "corre rre raw";
-		client->appData.compressLevel = 9;
-		client->appData.qualityLevel = 5;
-		client->appData.enableJPEG = true;
-		break;
-	default:
-		client->appData.encodingsString = "zrle ultra copyrect "
-										  "hextile zlib corre rre raw";
-		break;
-	}
+	connection->applyQualitySettings( client );
 
 	connection->m_framebufferState = FramebufferInitialized;
 
+	if( initializing )
+	{
+		// released in openConnection() after rfbInitClient() returned
+		connection->lockExtensionEncodings();
+	}
+
 	return true;
 }
 
@@ -181,6 +166,13 @@ void VeyonVncConnection::hookUpdateFB( rfbClient* client, int x, int y, int w, i
 
 	if( connection )
 	{
+		connection->m_scaledScreenUpdateLock.lock();
+		connection->m_scaledScreenDamage += QRect( x, y, w, h );
+		connection->m_scaledScreenUpdateLock.unlock();
+
+		connection->m_activityDamage += QRect( x, y, w, h );
+		connection->m_decodedUpdateBytes += qint64( w ) * h * client->format.bitsPerPixel / 8;
+
 		emit connection->imageUpdated( x, y, w, h );
 	}
 }
@@ -262,37 +254,109 @@ void VeyonVncConnection::hookOutputHandler( const char* format, ... )
 
 
 
+int8_t VeyonVncConnection::hookHandleVeyonMessage( rfbClient* client, rfbServerToClientMsg* msg )
+{
+	if( msg->type != rfbVeyonScaledFramebuffer )
+	{
+		return false;
+	}
+
+	rfbVeyonScaledFramebufferAckMsg message;
+	if( ReadFromRFBServer( client, reinterpret_cast<char *>( &message ) + 1, sz_rfbVeyonScaledFramebufferAckMsg - 1 ) == false )
+	{
+		return false;
+	}
+
+	auto connection = static_cast<VeyonVncConnection *>( rfbClientGetClientData( client, nullptr ) );
+
+	// ignore acknowledgements not requested by this connection
+	if( connection && connection->quality() == ThumbnailQuality )
+	{
+		connection->m_serverScalingSupported.storeRelease( 1 );
+
+		connection->m_scaledScreenUpdateLock.lock();
+		const auto scaledSize = connection->m_scaledSize;
+		connection->m_scaledScreenUpdateLock.unlock();
+
+		if( scaledSize.isEmpty() == false )
+		{
+			qDebug() << "VeyonVncConnection: server supports scaled framebuffers - requesting size" << scaledSize;
+			sendScaledSize( client, scaledSize );
+		}
+	}
+
+	return true;
+}
+
+
+
 void VeyonVncConnection::framebufferCleanup( void* framebuffer )
 {
-	delete[] static_cast<uchar *>( framebuffer );
+	FramebufferPool::instance().release( framebuffer );
 }
 
 
 
 
 VeyonVncConnection::VeyonVncConnection( QObject* parent ) :
-	QThread( parent ),
+	QObject( parent ),
 	m_serviceReachable( false ),
 	m_framebufferState( FramebufferInvalid ),
 	m_cl( nullptr ),
 	m_veyonAuthType( RfbVeyonAuth::Logon ),
 	m_quality( DefaultQuality ),
 	m_port( -1 ),
-	m_terminateTimer( this ),
 	m_framebufferUpdateInterval( 0 ),
+	m_framebufferInitTimer(),
+	m_serverScalingSupported( 0 ),
+	m_updateRequestDue( 0 ),
+	m_framebufferUpdatesPaused( 0 ),
+	m_focused( 0 ),
+	m_connectLatency( -1 ),
+	m_failedConnectionAttempts( 0 ),
+	m_reconnectDue( 0 ),
+	m_qualityBoundsChanged( 0 ),
+	m_statistics(),
+	m_messageTimer(),
+	m_updateRequestTimer(),
+	m_bytesReceived( -1 ),
+	m_decodedUpdateBytes( 0 ),
+	m_qualityController(),
+	m_activityDamage(),
+	m_activityDetector(),
+	m_inputEvents(),
 	m_image(),
+	m_scaledScreenUpdateLock(),
 	m_scaledScreenNeedsUpdate( false ),
-	m_scaledScreen(),
+	m_scaledScreenUpdateRunning( false ),
+	m_scaledScreenUpdate(),
+	m_scaledScreenUpdateTimer(),
 	m_scaledSize(),
-	m_state( Disconnected )
+	m_scaledScreenDamage(),
+	m_scaledScreenBackBuffer(),
+	m_scaledScreenSourceSize(),
+	m_scaledScreenLock(),
+	m_scaledScreen(),
+	m_state( Disconnected ),
+	m_running( 0 ),
+	m_stopRequested( 0 ),
+	m_engineThread( nullptr )
 {
 	rfbClientLog = hookOutputHandler;
 	rfbClientErr = hookOutputHandler;
 
-	m_terminateTimer.setSingleShot( true );
-	m_terminateTimer.setInterval( ThreadTerminationTimeout );
+	// drained input events are collected without allocating memory unless the input queue overflowed
+	m_inputEvents.reserve( VncInputQueue::Capacity );
 
-	connect( &m_terminateTimer, &QTimer::timeout, this, &VeyonVncConnection::terminate );
+	if( __veyonScaledFramebufferExt == nullptr )
+	{
+		__veyonScaledFramebufferExt = new rfbClientProtocolExtension;
+		__veyonScaledFramebufferExt->encodings = __veyonScaledFramebufferEncodings;
+		__veyonScaledFramebufferExt->handleEncoding = nullptr;
+		__veyonScaledFramebufferExt->handleMessage = hookHandleVeyonMessage;
+
+		rfbClientRegisterExtension( __veyonScaledFramebufferExt );
+	}
 
 	if( VeyonCore::config().authenticationMethod() == VeyonCore::KeyFileAuthentication )
 	{
@@ -308,17 +372,26 @@ VeyonVncConnection::~VeyonVncConnection()
 
 	if( isRunning() )
 	{
-		qWarning( "Waiting for VNC connection thread to finish." );
-		wait( ThreadTerminationTimeout );
+		qDebug( "VeyonVncConnection::~VeyonVncConnection(): waiting for connection to be closed" );
+		VeyonCore::vncConnectionEngine().removeConnection( this );
 	}
 
+	m_scaledScreenUpdate.waitForFinished();
+}
+
+
+
+void VeyonVncConnection::start()
+{
 	if( isRunning() )
 	{
-		qWarning( "Terminating hanging VNC connection thread!" );
-
-		terminate();
-		wait();
+		return;
 	}
+
+	m_stopRequested.storeRelease( 0 );
+	m_running.storeRelease( 1 );
+
+	VeyonCore::vncConnectionEngine().addConnection( this );
 }
 
 
@@ -334,24 +407,14 @@ void VeyonVncConnection::stop( bool deleteAfterFinished )
 					 this, &VeyonVncConnection::deleteLater );
 		}
 
+		m_scaledScreenLock.lockForWrite();
 		m_scaledScreen = QImage();
+		m_scaledScreenLock.unlock();
 
-		requestInterruption();
-
-		m_updateIntervalSleeper.wakeAll();
-
-		// thread termination causes deadlock when calling any QThread functions such as isRunning()
-		// or the destructor if the thread itself is stuck in a blocking (e.g. network) function
-		// therefore do not terminate the thread on windows but let it run in background as long
-		// as the blocking function is running
-#ifndef Q_OS_WIN32
-		// terminate thread in background after timeout
-		m_terminateTimer.start();
-#endif
+		m_stopRequested.storeRelease( 1 );
 
-		// stop timer if thread terminates properly before timeout
-		connect( this, &VeyonVncConnection::finished,
-				 &m_terminateTimer, &QTimer::stop );
+		// let the engine close the connection asynchronously
+		VeyonCore::vncConnectionEngine().wakeUp( this );
 	}
 	else if( deleteAfterFinished )
 	{
@@ -362,23 +425,6 @@ void VeyonVncConnection::stop( bool deleteAfterFinished )
 
 
 
-void VeyonVncConnection::reset( const QString &host )
-{
-	if( m_state != Connected && isRunning() )
-	{
-		setHost( host );
-	}
-	else
-	{
-		stop();
-		setHost( host );
-		start();
-	}
-}
-
-
-
-
 void VeyonVncConnection::setHost( const QString &host )
 {
 	QMutexLocker locker( &m_mutex );
@@ -433,211 +479,614 @@ QImage VeyonVncConnection::image() const
 void VeyonVncConnection::setFramebufferUpdateInterval( int interval )
 {
 	m_framebufferUpdateInterval = interval;
+	m_qualityBoundsChanged.storeRelease( 1 );
 }
 
 
 
 
-void VeyonVncConnection::rescaleScreen()
+void VeyonVncConnection::setScaledSize( QSize s )
 {
-	if( m_image.size().isValid() == false ||
-			m_scaledSize.isNull() ||
-			hasValidFrameBuffer() == false ||
-			m_scaledScreenNeedsUpdate == false )
+	m_scaledScreenUpdateLock.lock();
+	const auto changed = m_scaledSize != s;
+	m_scaledSize = s;
+	m_scaledScreenUpdateLock.unlock();
+
+	if( changed )
 	{
-		return;
+		updateScaledScreen();
+
+		// let server send framebuffer with new size
+		if( isFramebufferScaledByServer() )
+		{
+			enqueueEvent( new SetScaledSizeEvent( s ) );
+		}
+
+		if( m_quality == ThumbnailQuality )
+		{
+			m_qualityBoundsChanged.storeRelease( 1 );
+		}
 	}
+}
 
-	QReadLocker locker( &m_imgLock );
-	m_scaledScreen = m_image.scaled( m_scaledSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
 
-	m_scaledScreenNeedsUpdate = false;
+
+QSize VeyonVncConnection::scaledSize()
+{
+	QMutexLocker locker( &m_scaledScreenUpdateLock );
+	return m_scaledSize;
 }
 
 
 
+int VeyonVncConnection::thumbnailQualityLevel( QSize scaledSize )
+{
+	// artifacts are less visible in smaller thumbnails
+	const auto width = scaledSize.width();
+	if( width <= 160 )
+	{
+		return 3;
+	}
+	if( width <= 256 )
+	{
+		return 4;
+	}
+	if( width <= 400 )
+	{
+		return 5;
+	}
+	if( width <= 640 )
+	{
+		return 6;
+	}
+	if( width <= 800 )
+	{
+		return 7;
+	}
+
+	return 8;
+}
+
+
+
+int VeyonVncConnection::thumbnailCompressLevel( QSize scaledSize )
+{
+	// spend less CPU time on the server for compressing larger (and thus more frequently changing) thumbnails
+	return scaledSize.width() <= 320 ? 9 : 6;
+}
+
 
-void VeyonVncConnection::run()
+
+int VeyonVncConnection::thumbnailUpdateInterval( int updateInterval, QSize scaledSize )
 {
-	while( isInterruptionRequested() == false )
+	// changes are hardly noticeable in small thumbnails so request them less often
+	const auto width = scaledSize.width();
+	if( width <= 160 )
 	{
-		establishConnection();
-		handleConnection();
-		closeConnection();
+		return updateInterval * 2;
+	}
+	if( width <= 256 )
+	{
+		return updateInterval * 3 / 2;
 	}
 
-	setState( Disconnected );
+	return updateInterval;
 }
 
 
 
-void VeyonVncConnection::establishConnection()
+VncQualityController::Bounds VeyonVncConnection::qualityBounds()
 {
-	QMutex sleeperMutex;
+	switch( m_quality )
+	{
+	case ScreenshotQuality:
+		return { 9, 9, 0, 0, 1, 0, "raw", "raw", false };
+	case RemoteControlQuality:
+		// keep cheap encodings on fast links and switch to Tight/JPEG as soon as interaction suffers
+		return { 5, 9, 1, 6, 1, RemoteControlTransferTime,
+				"copyrect hextile raw",
+				"tight copyrect zrle hextile raw", true };
+	case ThumbnailQuality:
+	{
+		// thumbnails are displayed at a fraction of their size so lossy JPEG compression is sufficient,
+		// however large thumbnails must not degrade as far as small ones
+		const auto size = scaledSize();
+		const auto qualityLevel = thumbnailQualityLevel( size );
+		return { qMax( 1, qualityLevel - 4 ), qualityLevel, thumbnailCompressLevel( size ), 9, 4, ThumbnailTransferTime,
+				"tight zrle ultra copyrect hextile zlib corre rre raw",
+				"tight zrle ultra copyrect hextile zlib corre rre raw", true };
+	}
+	default:
+		break;
+	}
+
+	return { 9, 9, 0, 9, 2, DefaultTransferTime,
+			"zrle ultra copyrect hextile zlib corre rre raw",
+			"tight zrle ultra copyrect hextile zlib corre rre raw", false };
+}
 
-	setState( Connecting );
 
-	m_framebufferState = FramebufferInvalid;
 
-	while( isInterruptionRequested() == false && m_state != Connected ) // try to connect as long as the server allows
+int VeyonVncConnection::baseUpdateInterval()
+{
+	if( m_quality == ThumbnailQuality && m_framebufferUpdateInterval > 0 )
 	{
-		m_cl = rfbGetClient( 8, 3, 4 );
-		m_cl->MallocFrameBuffer = hookInitFrameBuffer;
-		m_cl->canHandleNewFBSize = true;
-		m_cl->GotFrameBufferUpdate = hookUpdateFB;
-		m_cl->FinishedFrameBufferUpdate = hookFinishFrameBufferUpdate;
-		m_cl->HandleCursorPos = hookHandleCursorPos;
-		m_cl->GotCursorShape = hookCursorShape;
-		m_cl->GotXCutText = hookCutText;
-		rfbClientSetClientData( m_cl, nullptr, this );
+		return thumbnailUpdateInterval( m_framebufferUpdateInterval, scaledSize() );
+	}
 
-		m_mutex.lock();
+	return m_framebufferUpdateInterval;
+}
 
-		if( m_port < 0 ) // use default port?
-		{
-			m_cl->serverPort = VeyonCore::config().primaryServicePort();
-		}
-		else
+
+
+void VeyonVncConnection::applyQualitySettings( rfbClient* client ) const
+{
+	const auto& settings = m_qualityController.settings();
+
+	client->appData.encodingsString = settings.encodings;
+	client->appData.compressLevel = settings.compressLevel;
+	client->appData.qualityLevel = settings.qualityLevel;
+	client->appData.enableJPEG = settings.enableJPEG;
+}
+
+
+
+int VeyonVncConnection::updateInterval() const
+{
+	if( m_framebufferUpdateInterval <= 0 )
+	{
+		return 0;
+	}
+
+	const auto interval = m_qualityController.settings().updateInterval;
+
+	// idle screens of unfocused computers do not need to be updated as often
+	if( m_quality == ThumbnailQuality && m_focused.loadAcquire() == 0 && m_activityDetector.isIdle() )
+	{
+		return interval * IdleUpdateIntervalFactor;
+	}
+
+	return interval;
+}
+
+
+
+VncBandwidthScheduler::Priority VeyonVncConnection::bandwidthPriority() const
+{
+	if( m_quality == RemoteControlQuality )
+	{
+		return VncBandwidthScheduler::RemoteControlPriority;
+	}
+
+	if( m_focused.loadAcquire() )
+	{
+		return VncBandwidthScheduler::FocusedPriority;
+	}
+
+	if( m_quality == ThumbnailQuality && areFramebufferUpdatesPaused() == false )
+	{
+		return VncBandwidthScheduler::VisiblePriority;
+	}
+
+	return VncBandwidthScheduler::BackgroundPriority;
+}
+
+
+
+void VeyonVncConnection::lockExtensionEncodings() const
+{
+	__veyonScaledFramebufferEncodingsLock.lock();
+
+	__veyonScaledFramebufferEncodings[0] = m_quality == ThumbnailQuality ? rfbEncodingVeyonScaledFramebuffer : 0;
+}
+
+
+
+void VeyonVncConnection::unlockExtensionEncodings()
+{
+	__veyonScaledFramebufferEncodings[0] = 0;
+
+	__veyonScaledFramebufferEncodingsLock.unlock();
+}
+
+
+
+bool VeyonVncConnection::isFramebufferScaledByServer() const
+{
+	return m_quality == ThumbnailQuality && m_serverScalingSupported.loadAcquire();
+}
+
+
+
+void VeyonVncConnection::sendScaledSize( rfbClient* client, QSize size )
+{
+	rfbVeyonSetScaledSizeMsg message;
+	message.type = rfbVeyonScaledFramebuffer;
+	message.pad = 0;
+	message.width = qToBigEndian<uint16_t>( static_cast<uint16_t>( size.width() ) );
+	message.height = qToBigEndian<uint16_t>( static_cast<uint16_t>( size.height() ) );
+
+	WriteToRFBServer( client, reinterpret_cast<char *>( &message ), sz_rfbVeyonSetScaledSizeMsg );
+}
+
+
+
+QImage VeyonVncConnection::scaledScreen() const
+{
+	QReadLocker locker( &m_scaledScreenLock );
+	return m_scaledScreen;
+}
+
+
+
+void VeyonVncConnection::updateScaledScreen()
+{
+	QMutexLocker locker( &m_scaledScreenUpdateLock );
+
+	m_scaledScreenNeedsUpdate = true;
+
+	// a running update picks up the new request when done
+	if( m_scaledScreenUpdateRunning == false )
+	{
+		m_scaledScreenUpdateRunning = true;
+		m_scaledScreenUpdate = QtConcurrent::run( [this]() { rescaleScreen(); } );
+	}
+}
+
+
+
+void VeyonVncConnection::rescaleScreen()
+{
+	forever
+	{
+		m_scaledScreenUpdateLock.lock();
+		if( m_scaledScreenNeedsUpdate == false )
 		{
-			m_cl->serverPort = m_port;
+			m_scaledScreenUpdateRunning = false;
+			m_scaledScreenUpdateLock.unlock();
+			return;
 		}
 
-		free( m_cl->serverHost );
-		m_cl->serverHost = strdup( m_host.toUtf8().constData() );
+		m_scaledScreenNeedsUpdate = false;
+		const auto scaledSize = m_scaledSize;
+		const auto damage = m_scaledScreenDamage;
+		m_scaledScreenDamage = QRegion();
+		m_scaledScreenUpdateLock.unlock();
 
-		m_mutex.unlock();
+		const auto currentImage = image();
 
-		emit newClient( m_cl );
+		QElapsedTimer scaleTimer;
+		scaleTimer.start();
 
-		m_serviceReachable = false;
+		if( currentImage.size().isValid() == false ||
+				scaledSize.isEmpty() ||
+				hasValidFrameBuffer() == false )
+		{
+			// make sure to rescale everything once the framebuffer is valid
+			m_scaledScreenBackBuffer = QImage();
+			continue;
+		}
 
-		if( rfbInitClient( m_cl, nullptr, nullptr ) )
+		if( m_scaledScreenBackBuffer.size() != scaledSize ||
+				m_scaledScreenSourceSize != currentImage.size() ||
+				FramebufferScaler::canScale( currentImage, scaledSize ) == false ||
+				isFullRescaleRequired( damage, currentImage.size() ) )
+		{
+			m_scaledScreenBackBuffer = FramebufferScaler::scaled( currentImage, scaledSize );
+			m_scaledScreenSourceSize = currentImage.size();
+		}
+		else if( damage.isEmpty() )
 		{
-			setState( Connected );
+			continue;
 		}
 		else
 		{
-			// rfbInitClient() calls rfbClientCleanup() when failed
-			m_cl = nullptr;
+			rescaleDamagedRegion( currentImage, damage );
+		}
 
-			// guess reason why connection failed
-			if( m_serviceReachable == false )
-			{
-				if( VeyonCore::platform().networkFunctions().ping( m_host ) == false )
-				{
-					setState( HostOffline );
-				}
-				else
-				{
-					setState( ServiceUnreachable );
-				}
-			}
-			else if( m_framebufferState == FramebufferInvalid )
-			{
-				setState( AuthenticationFailed );
-			}
-			else
-			{
-				// failed for an unknown reason
-				setState( ConnectionFailed );
-			}
+		m_statistics.recordScaling( scaleTimer.nsecsElapsed() / 1000 );
 
-			// do not sleep when already requested to stop
-			if( isInterruptionRequested() )
-			{
-				break;
-			}
+		m_scaledScreenLock.lockForWrite();
+		m_scaledScreen = m_scaledScreenBackBuffer;
+		m_scaledScreenLock.unlock();
 
-			// wait a bit until next connect
-			sleeperMutex.lock();
-			if( m_framebufferUpdateInterval > 0 )
-			{
-				m_updateIntervalSleeper.wait( &sleeperMutex, static_cast<unsigned long>( m_framebufferUpdateInterval ) );
-			}
-			else
-			{
-				// default: retry every second
-				m_updateIntervalSleeper.wait( &sleeperMutex, 1000 );
-			}
-			sleeperMutex.unlock();
-		}
+		emit scaledScreenUpdated();
+	}
+}
+
+
+
+bool VeyonVncConnection::isFullRescaleRequired( const QRegion& damage, QSize sourceSize )
+{
+	if( damage.rectCount() > MaximumDamagedRectCount )
+	{
+		return true;
+	}
+
+	const auto boundingRect = damage.boundingRect();
+
+	// rescaling many small areas separately is slower than one large area
+	return boundingRect.width() * boundingRect.height() * 2 > sourceSize.width() * sourceSize.height();
+}
+
+
+
+void VeyonVncConnection::rescaleDamagedRegion( const QImage& source, const QRegion& damage )
+{
+	const auto rects = damage.rects();
+	for( const auto& rect : rects )
+	{
+		FramebufferScaler::scale( source, m_scaledScreenBackBuffer,
+								  FramebufferScaler::mapToTarget( rect, source.size(), m_scaledScreenBackBuffer.size() ) );
 	}
 }
 
 
 
-void VeyonVncConnection::handleConnection()
+
+bool VeyonVncConnection::establishConnection()
 {
-	QMutex sleeperMutex;
+	if( m_state == Disconnected )
+	{
+		setState( Connecting );
+	}
+
+	m_framebufferState = FramebufferInvalid;
+	m_reconnectDue.storeRelease( 0 );
+
+	m_mutex.lock();
+	const auto host = m_host;
+	m_mutex.unlock();
+
+	// use shared cache instead of letting libvncclient query the name server on every attempt
+	const auto address = HostResolver::preferredAddress( VeyonCore::hostResolver().resolve( host ) );
+	if( address.isNull() )
+	{
+		setState( HostOffline );
+		m_failedConnectionAttempts.fetchAndAddOrdered( 1 );
+		return false;
+	}
+
+	m_cl = rfbGetClient( 8, 3, 4 );
+	m_cl->MallocFrameBuffer = hookInitFrameBuffer;
+	m_cl->canHandleNewFBSize = true;
+	m_cl->GotFrameBufferUpdate = hookUpdateFB;
+	m_cl->FinishedFrameBufferUpdate = hookFinishFrameBufferUpdate;
+	m_cl->HandleCursorPos = hookHandleCursorPos;
+	m_cl->GotCursorShape = hookCursorShape;
+	m_cl->GotXCutText = hookCutText;
+	rfbClientSetClientData( m_cl, nullptr, this );
+
+	m_mutex.lock();
+
+	if( m_port < 0 ) // use default port?
+	{
+		m_cl->serverPort = VeyonCore::config().primaryServicePort();
+	}
+	else
+	{
+		m_cl->serverPort = m_port;
+	}
 
-	QElapsedTimer updateTimer;
-	QElapsedTimer connectionTime;
+	const auto serverPort = m_cl->serverPort;
 
-	connectionTime.start();
+	free( m_cl->serverHost );
+	m_cl->serverHost = strdup( address.toString().toUtf8().constData() );
 
-	// Main VNC event loop
-	while( isInterruptionRequested() == false )
+	m_mutex.unlock();
+
+	emit newClient( m_cl );
+
+	m_serviceReachable = false;
+	m_serverScalingSupported.storeRelease( 0 );
+
+	m_qualityBoundsChanged.storeRelease( 0 );
+	m_qualityController.setEnabled( VeyonCore::config().adaptiveConnectionQualityEnabled() );
+	m_qualityController.reset( qualityBounds(), baseUpdateInterval() );
+
+	const auto initialized = rfbInitClient( m_cl, nullptr, nullptr );
+
+	if( m_framebufferState != FramebufferInvalid )
+	{
+		unlockExtensionEncodings();
+	}
+
+	if( initialized )
 	{
-		updateTimer.start();
+		m_updateRequestDue.storeRelease( 0 );
+		m_failedConnectionAttempts.storeRelease( 0 );
+
+		m_statistics.reset();
+		m_inputQueue.clear();
+		m_updateRequestTimer.invalidate();
+		m_bytesReceived = VncConnectionStatistics::socketBytesReceived( m_cl->sock );
+		m_decodedUpdateBytes = 0;
+
+		setState( Connected );
+
+		return true;
+	}
+
+	// rfbInitClient() calls rfbClientCleanup() when failed
+	m_cl = nullptr;
 
-		const int i = WaitForMessage( m_cl, MessageWaitTimeout );
-		if( isInterruptionRequested() || i < 0 )
+	// guess reason why connection failed
+	if( m_serviceReachable == false )
+	{
+		if( VeyonCore::hostProber().isReachable( host, serverPort ) == false )
 		{
-			break;
+			setState( HostOffline );
 		}
-		else if( i )
+		else
 		{
-			// handle all available messages
-			bool handledOkay = true;
-			do {
-				handledOkay &= HandleRFBServerMessage( m_cl );
-			} while( handledOkay && WaitForMessage( m_cl, 0 ) );
-
-			if( handledOkay == false )
+			if( m_state == HostOffline )
 			{
-				break;
+				// host just came up so retry at normal rate
+				m_failedConnectionAttempts.storeRelease( 0 );
 			}
+			setState( ServiceUnreachable );
 		}
+	}
+	else if( m_framebufferState == FramebufferInvalid )
+	{
+		setState( AuthenticationFailed );
+	}
+	else
+	{
+		// failed for an unknown reason
+		setState( ConnectionFailed );
+	}
 
-		switch( m_framebufferState )
-		{
-		case FramebufferInitialized:
-			// initial framebuffer timeout exceeded?
-			if( connectionTime.hasExpired( InitialFrameBufferTimeout ) )
-			{
-				// no so disconnect and try again
-				qDebug( "VeyonVncConnection: InitialFrameBufferTimeout exceeded - disconnecting" );
-				return;
-			}
-			else
-			{
-				// not yet so again request initial full framebuffer update
-				SendFramebufferUpdateRequest( m_cl, 0, 0, framebufferSize().width(), framebufferSize().height(), false );
-			}
-			break;
+	m_failedConnectionAttempts.fetchAndAddOrdered( 1 );
 
-		case FramebufferFirstUpdate:
-			SendFramebufferUpdateRequest( m_cl, 0, 0, framebufferSize().width(), framebufferSize().height(), false );
-			break;
+	return false;
+}
 
-		default:
-			SendFramebufferUpdateRequest( m_cl, 0, 0, framebufferSize().width(), framebufferSize().height(), true );
-			break;
+
+
+bool VeyonVncConnection::handleServerMessages()
+{
+	// handle all available messages including data already buffered by libvncclient
+	bool handledOkay = true;
+	do {
+		m_messageTimer.start();
+		handledOkay &= HandleRFBServerMessage( m_cl );
+	} while( handledOkay && isStopRequested() == false &&
+			 ( m_cl->buffered > 0 || WaitForMessage( m_cl, 0 ) > 0 ) );
+
+	return handledOkay;
+}
+
+
+
+int VeyonVncConnection::handleUpdateTimer()
+{
+	if( areFramebufferUpdatesPaused() )
+	{
+		// do not let the server run into the initial framebuffer timeout as we did not request anything
+		if( m_framebufferState == FramebufferInitialized )
+		{
+			m_framebufferInitTimer.start();
+		}
+		else if( m_framebufferState == FramebufferValid )
+		{
+			// keep the connection alive (and let dead links time out) by requesting a single pixel only
+			SendFramebufferUpdateRequest( m_cl, 0, 0, 1, 1, true );
 		}
 
 		sendEvents();
 
-		auto remainingUpdateInterval = m_framebufferUpdateInterval - updateTimer.elapsed();
+		return PausedUpdateInterval;
+	}
+
+	if( m_framebufferState == FramebufferInitialized &&
+			m_framebufferInitTimer.hasExpired( InitialFrameBufferTimeout ) )
+	{
+		// no so disconnect and try again
+		qDebug( "VeyonVncConnection: InitialFrameBufferTimeout exceeded - disconnecting" );
+		return -1;
+	}
+
+	if( ( m_qualityBoundsChanged.fetchAndStoreAcquire( 0 ) &&
+		  m_qualityController.setBounds( qualityBounds(), baseUpdateInterval() ) ) ||
+			m_qualityController.adjust() )
+	{
+		applyQualitySettings( m_cl );
 
-		if( remainingUpdateInterval > 0 && isInterruptionRequested() == false )
+		lockExtensionEncodings();
+		SetFormatAndEncodings( m_cl );
+		unlockExtensionEncodings();
+	}
+
+	// always request the initial framebuffer right away - it is charged once received
+	if( m_framebufferState != FramebufferInitialized )
+	{
+		const auto admissionDelay = VeyonCore::vncConnectionEngine().bandwidthScheduler().
+				admitUpdateRequest( this, bandwidthPriority() );
+		if( admissionDelay > 0 )
 		{
-			sleeperMutex.lock();
-			m_updateIntervalSleeper.wait( &sleeperMutex, static_cast<unsigned long>( remainingUpdateInterval ) );
-			sleeperMutex.unlock();
+			sendEvents();
+			return admissionDelay;
 		}
 	}
 
+	requestFramebufferUpdate();
+
 	sendEvents();
+
+	m_scaledScreenUpdateLock.lock();
+	const auto scaledScreenNeedsUpdate = m_scaledScreenNeedsUpdate && m_scaledScreenUpdateRunning == false;
+	m_scaledScreenUpdateLock.unlock();
+
+	if( scaledScreenNeedsUpdate )
+	{
+		m_scaledScreenUpdateTimer.start();
+		updateScaledScreen();
+	}
+
+	if( m_framebufferUpdateInterval > 0 )
+	{
+		return updateInterval();
+	}
+
+	// without update interval the next update is requested as soon as the current one
+	// has been received - just make sure to re-request if an update got lost
+	return MessageWaitTimeout;
+}
+
+
+
+void VeyonVncConnection::setFramebufferUpdatesPaused( bool paused )
+{
+	if( m_framebufferUpdatesPaused.fetchAndStoreOrdered( paused ? 1 : 0 ) != ( paused ? 1 : 0 ) &&
+			paused == false && isRunning() )
+	{
+		// resume with an incremental update containing everything changed while paused
+		m_updateRequestDue.storeRelease( 1 );
+		VeyonCore::vncConnectionEngine().wakeUp( this );
+	}
+}
+
+
+
+void VeyonVncConnection::requestFramebufferUpdate()
+{
+	switch( m_framebufferState )
+	{
+	case FramebufferInitialized:
+	case FramebufferFirstUpdate:
+		// (again) request initial full framebuffer update
+		SendFramebufferUpdateRequest( m_cl, 0, 0, framebufferSize().width(), framebufferSize().height(), false );
+		break;
+
+	default:
+		SendFramebufferUpdateRequest( m_cl, 0, 0, framebufferSize().width(), framebufferSize().height(), true );
+		break;
+	}
+
+	// measure latency from the first outstanding request
+	if( m_updateRequestTimer.isValid() == false )
+	{
+		m_updateRequestTimer.start();
+	}
+}
+
+
+
+QString VeyonVncConnection::currentEncoding() const
+{
+	if( isFramebufferScaledByServer() )
+	{
+		return QStringLiteral("veyon-scaled");
+	}
+
+	// libvncclient does not expose the encoding of received rects so report the preferred one
+	if( m_cl && m_cl->appData.encodingsString )
+	{
+		return QString::fromLatin1( m_cl->appData.encodingsString ).section( QLatin1Char(' '), 0, 0 );
+	}
+
+	return QStringLiteral("unknown");
 }
 
 
@@ -655,6 +1104,72 @@ void VeyonVncConnection::closeConnection()
 
 
 
+void VeyonVncConnection::finishEngineProcessing()
+{
+	setState( Disconnected );
+
+	emit finished();
+}
+
+
+
+int VeyonVncConnection::socketDescriptor() const
+{
+	return m_cl ? m_cl->sock : -1;
+}
+
+
+
+int VeyonVncConnection::reconnectInterval() const
+{
+	const auto baseInterval = m_framebufferUpdateInterval > 0 ? m_framebufferUpdateInterval : DefaultReconnectInterval;
+
+	const auto failedAttempts = m_failedConnectionAttempts.loadAcquire();
+	if( failedAttempts <= 1 )
+	{
+		return baseInterval;
+	}
+
+	// double interval with each failed attempt up to configured maximum
+	const auto maximumInterval = qMax<qint64>( baseInterval, VeyonCore::config().maximumReconnectInterval() * 1000 );
+	const auto interval = qMin<qint64>( maximumInterval, qint64( baseInterval ) << qMin( failedAttempts - 1, 20 ) );
+
+	// randomize second half of interval so reconnects to many offline hosts do not synchronize
+	static thread_local std::minstd_rand randomGenerator( std::random_device{}() );
+	std::uniform_int_distribution<qint64> jitter( 0, interval / 2 );
+
+	return static_cast<int>( interval - interval / 2 + jitter( randomGenerator ) );
+}
+
+
+
+void VeyonVncConnection::resetReconnectBackoff()
+{
+	m_failedConnectionAttempts.storeRelease( 0 );
+
+	if( isConnected() == false )
+	{
+		m_reconnectDue.storeRelease( 1 );
+		VeyonCore::vncConnectionEngine().wakeUp( this );
+	}
+}
+
+
+
+bool VeyonVncConnection::isReconnectDue()
+{
+	return m_reconnectDue.fetchAndStoreAcquire( 0 ) != 0;
+}
+
+
+
+bool VeyonVncConnection::isUpdateRequestDue()
+{
+	return m_updateRequestDue.fetchAndStoreAcquire( 0 ) != 0;
+}
+
+
+
 void VeyonVncConnection::setState( State state )
 {
 	if( state != m_state )
@@ -669,6 +1184,25 @@ void VeyonVncConnection::setState( State state )
 
 void VeyonVncConnection::finishFrameBufferUpdate()
 {
+	const auto bytesReceived = VncConnectionStatistics::socketBytesReceived( m_cl->sock );
+	const auto updateBytes = bytesReceived >= 0 && m_bytesReceived >= 0 ? bytesReceived - m_bytesReceived : -1;
+	const auto transferTime = m_messageTimer.nsecsElapsed() / 1000;
+
+	m_statistics.recordUpdate( updateBytes,
+							   m_updateRequestTimer.isValid() ? m_updateRequestTimer.nsecsElapsed() / 1000 : -1,
+							   currentEncoding(),
+							   transferTime );
+	m_qualityController.recordUpdate( updateBytes, transferTime );
+	// without socket counters charge the uncompressed size which limits the bandwidth conservatively
+	VeyonCore::vncConnectionEngine().bandwidthScheduler().chargeUpdate( this, updateBytes >= 0 ? updateBytes : m_decodedUpdateBytes );
+
+	m_bytesReceived = bytesReceived;
+	m_decodedUpdateBytes = 0;
+	m_updateRequestTimer.invalidate();
+
+	m_activityDetector.update( m_image, m_activityDamage );
+	m_activityDamage = QRegion();
+
 	switch( m_framebufferState )
 	{
 	case FramebufferInitialized:
@@ -684,13 +1218,46 @@ void VeyonVncConnection::finishFrameBufferUpdate()
 
 	emit framebufferUpdateComplete();
 
-	m_scaledScreenNeedsUpdate = true;
+	// do not rescale more often than the update interval - if throttled, handleUpdateTimer()
+	// will pick up the pending update
+	if( m_scaledScreenUpdateTimer.isValid() == false ||
+			m_scaledScreenUpdateTimer.hasExpired( updateInterval() ) )
+	{
+		m_scaledScreenUpdateTimer.start();
+		updateScaledScreen();
+	}
+	else
+	{
+		m_scaledScreenUpdateLock.lock();
+		m_scaledScreenNeedsUpdate = true;
+		m_scaledScreenUpdateLock.unlock();
+	}
+
+	if( m_framebufferUpdateInterval <= 0 )
+	{
+		m_updateRequestDue.storeRelease( 1 );
+	}
 }
 
 
 
 void VeyonVncConnection::sendEvents()
 {
+	// send input first as it is most latency-sensitive
+	m_inputQueue.drain( m_inputEvents );
+
+	for( const auto& event : qAsConst(m_inputEvents) )
+	{
+		if( event.type == VncInputQueue::Event::Pointer )
+		{
+			SendPointerEvent( m_cl, event.x, event.y, event.buttonMask );
+		}
+		else
+		{
+			SendKeyEvent( m_cl, event.key, event.pressed ? TRUE : FALSE );
+		}
+	}
+
 	m_mutex.lock();
 
 	while( m_eventQueue.isEmpty() == false )
@@ -721,6 +1288,8 @@ void VeyonVncConnection::enqueueEvent( MessageEvent *e )
 	}
 
 	m_eventQueue.enqueue( e );
+
+	VeyonCore::vncConnectionEngine().wakeUp( this );
 }
 
 
@@ -728,7 +1297,10 @@ void VeyonVncConnection::enqueueEvent( MessageEvent *e )
 
 void VeyonVncConnection::mouseEvent( int x, int y, int buttonMask )
 {
-	enqueueEvent( new PointerClientEvent( x, y, buttonMask ) );
+	if( m_state == Connected && m_inputQueue.enqueuePointerEvent( x, y, buttonMask ) )
+	{
+		VeyonCore::vncConnectionEngine().wakeUp( this );
+	}
 }
 
 
@@ -736,7 +1308,10 @@ void VeyonVncConnection::mouseEvent( int x, int y, int buttonMask )
 
 void VeyonVncConnection::keyEvent( unsigned int key, bool pressed )
 {
-	enqueueEvent( new KeyClientEvent( key, pressed ) );
+	if( m_state == Connected && m_inputQueue.enqueueKeyEvent( key, pressed ) )
+	{
+		VeyonCore::vncConnectionEngine().wakeUp( this );
+	}
 }
 
 
@@ -0,0 +1,164 @@
+/*
+ * VncBandwidthScheduler.cpp - implementation of VncBandwidthScheduler class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QMutexLocker>
+#include <QtMath>
+
+#include "VncBandwidthScheduler.h"
+
+
+VncBandwidthScheduler::VncBandwidthScheduler() :
+	m_mutex(),
+	m_bytesPerSecond( 0 ),
+	m_clock(),
+	m_lastRefill( 0 ),
+	m_flows()
+{
+	m_clock.start();
+}
+
+
+
+void VncBandwidthScheduler::setBandwidth( qint64 bytesPerSecond )
+{
+	QMutexLocker locker( &m_mutex );
+
+	m_bytesPerSecond = qMax<qint64>( 0, bytesPerSecond );
+	m_lastRefill = m_clock.elapsed();
+}
+
+
+
+int VncBandwidthScheduler::admitUpdateRequest( VeyonVncConnection* connection, Priority priority )
+{
+	QMutexLocker locker( &m_mutex );
+
+	if( m_bytesPerSecond <= 0 )
+	{
+		return 0;
+	}
+
+	const auto now = m_clock.elapsed();
+
+	auto it = m_flows.find( connection );
+	if( it == m_flows.end() )
+	{
+		// let new connections start right away
+		it = m_flows.insert( connection, { priority, MinimumBurst, now } );
+	}
+
+	it->priority = priority;
+	it->lastActivity = now;
+
+	refill( now );
+
+	if( it->deficit > 0 )
+	{
+		return 0;
+	}
+
+	// wait until the connection's share of the bandwidth has made up for the deficit
+	const auto bytesPerMillisecond = qMax<double>( 1, double( m_bytesPerSecond ) * weight( priority ) / activeWeight( now ) / 1000 );
+
+	return qBound<int>( TickInterval, qCeil( ( 1 - it->deficit ) / bytesPerMillisecond ), MaximumRetryDelay );
+}
+
+
+
+void VncBandwidthScheduler::chargeUpdate( VeyonVncConnection* connection, qint64 bytes )
+{
+	if( bytes <= 0 )
+	{
+		return;
+	}
+
+	QMutexLocker locker( &m_mutex );
+
+	auto it = m_flows.find( connection );
+	if( it != m_flows.end() )
+	{
+		it->deficit -= bytes;
+	}
+}
+
+
+
+void VncBandwidthScheduler::removeConnection( VeyonVncConnection* connection )
+{
+	QMutexLocker locker( &m_mutex );
+	m_flows.remove( connection );
+}
+
+
+
+void VncBandwidthScheduler::refill( qint64 now )
+{
+	const auto elapsed = now - m_lastRefill;
+	if( elapsed < TickInterval )
+	{
+		return;
+	}
+
+	m_lastRefill = now;
+
+	const auto totalWeight = activeWeight( now );
+	if( totalWeight <= 0 )
+	{
+		return;
+	}
+
+	const auto budget = m_bytesPerSecond * qMin<qint64>( elapsed, TickInterval * BurstTickCount ) / 1000;
+
+	for( auto it = m_flows.begin(); it != m_flows.end(); ++it )
+	{
+		if( now - it->lastActivity >= ActiveFlowTimeout )
+		{
+			continue;
+		}
+
+		const auto flowWeight = weight( it->priority );
+		const auto maximumDeficit = qMax<qint64>( MinimumBurst,
+												  m_bytesPerSecond * TickInterval * BurstTickCount / 1000 *
+												  flowWeight / totalWeight );
+
+		it->deficit = qMin( maximumDeficit, it->deficit + budget * flowWeight / totalWeight );
+	}
+}
+
+
+
+int VncBandwidthScheduler::activeWeight( qint64 now ) const
+{
+	int totalWeight = 0;
+
+	for( const auto& flow : m_flows )
+	{
+		if( now - flow.lastActivity < ActiveFlowTimeout )
+		{
+			totalWeight += weight( flow.priority );
+		}
+	}
+
+	return totalWeight;
+}
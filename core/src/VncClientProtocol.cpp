@@ -445,6 +445,12 @@ bool VncClientProtocol::receiveFramebufferUpdateMessage()
 			return false;
 		}
 
+		if( rectHeader.encoding == rfbEncodingNewFBSize )
+		{
+			m_framebufferWidth = rectHeader.r.w;
+			m_framebufferHeight = rectHeader.r.h;
+		}
+
 		if( isPseudoEncoding( rectHeader ) == false &&
 			rectHeader.r.x+rectHeader.r.w <= m_framebufferWidth &&
 			rectHeader.r.y+rectHeader.r.h <= m_framebufferHeight )
@@ -594,6 +600,9 @@ bool VncClientProtocol::handleRect( QBuffer& buffer, rfbFramebufferUpdateRectHea
 	case rfbEncodingZYWRLE:
 		return handleRectEncodingZRLE( buffer );
 
+	case rfbEncodingTight:
+		return handleRectEncodingTight( buffer, rectHeader );
+
 	case rfbEncodingPointerPos:
 	case rfbEncodingKeyboardLedState:
 	case rfbEncodingNewFBSize:
@@ -761,6 +770,125 @@ bool VncClientProtocol::handleRectEncodingZRLE(QBuffer &buffer)
 
 
 
+bool VncClientProtocol::handleRectEncodingTight( QBuffer& buffer, const rfbFramebufferUpdateRectHeader rectHeader )
+{
+	static constexpr uint8_t TightPng = 0x0A;
+
+	uint8_t compressionControl = 0;
+	if( buffer.read( reinterpret_cast<char *>( &compressionControl ), 1 ) != 1 )
+	{
+		return false;
+	}
+
+	// pixels are sent with 3 bytes only for 24 bit true colour formats
+	const uint pixelSize = ( m_pixelFormat.bitsPerPixel == 32 && m_pixelFormat.depth == 24 &&
+							 qFromBigEndian( m_pixelFormat.redMax ) == 0xff &&
+							 qFromBigEndian( m_pixelFormat.greenMax ) == 0xff &&
+							 qFromBigEndian( m_pixelFormat.blueMax ) == 0xff ) ? 3 : m_pixelFormat.bitsPerPixel / 8;
+
+	// lower 4 bits only signal resets of zlib streams
+	const uint8_t compressionType = compressionControl >> 4;
+
+	if( compressionType == rfbTightFill )
+	{
+		return buffer.read( pixelSize ).size() == static_cast<qint64>( pixelSize );
+	}
+
+	uint32_t length = 0;
+
+	if( compressionType == rfbTightJpeg || compressionType == TightPng )
+	{
+		return readTightCompactLength( buffer, length ) &&
+				buffer.read( length ).size() == static_cast<qint64>( length );
+	}
+
+	if( compressionType > rfbTightMaxSubencoding )
+	{
+		qCritical() << Q_FUNC_INFO << "invalid Tight compression control" << compressionControl;
+		m_socket->close();
+		return false;
+	}
+
+	// basic compression with optional filter
+	uint8_t filter = rfbTightFilterCopy;
+	if( ( compressionType & rfbTightExplicitFilter ) &&
+			buffer.read( reinterpret_cast<char *>( &filter ), 1 ) != 1 )
+	{
+		return false;
+	}
+
+	uint rowSize = rectHeader.r.w * pixelSize;
+
+	if( filter == rfbTightFilterPalette )
+	{
+		uint8_t paletteSize = 0;
+		if( buffer.read( reinterpret_cast<char *>( &paletteSize ), 1 ) != 1 )
+		{
+			return false;
+		}
+
+		const uint colorCount = paletteSize + 1;
+		if( buffer.read( colorCount * pixelSize ).size() != static_cast<qint64>( colorCount * pixelSize ) )
+		{
+			return false;
+		}
+
+		// two colors are encoded as bitmap, more colors as one byte per pixel
+		rowSize = colorCount == 2 ? ( rectHeader.r.w + 7u ) / 8u : rectHeader.r.w;
+	}
+	else if( filter != rfbTightFilterCopy && filter != rfbTightFilterGradient )
+	{
+		qCritical() << Q_FUNC_INFO << "invalid Tight filter" << filter;
+		m_socket->close();
+		return false;
+	}
+
+	const auto dataSize = rowSize * rectHeader.r.h;
+
+	// small amounts of data are sent uncompressed
+	if( dataSize < rfbTightMinToCompress )
+	{
+		return buffer.read( dataSize ).size() == static_cast<qint64>( dataSize );
+	}
+
+	return readTightCompactLength( buffer, length ) &&
+			buffer.read( length ).size() == static_cast<qint64>( length );
+}
+
+
+
+bool VncClientProtocol::readTightCompactLength( QBuffer& buffer, uint32_t& length )
+{
+	length = 0;
+
+	// 7 bits per byte with MSB indicating another byte to follow, the third byte uses all 8 bits
+	for( int i = 0; i < 3; ++i )
+	{
+		uint8_t byte = 0;
+		if( buffer.read( reinterpret_cast<char *>( &byte ), 1 ) != 1 )
+		{
+			return false;
+		}
+
+		if( i < 2 )
+		{
+			length |= static_cast<uint32_t>( byte & 0x7f ) << ( 7 * i );
+			if( ( byte & 0x80 ) == 0 )
+			{
+				return true;
+			}
+		}
+		else
+		{
+			length |= static_cast<uint32_t>( byte ) << 14;
+		}
+	}
+
+	return true;
+}
+
+
+
 bool VncClientProtocol::isPseudoEncoding( rfbFramebufferUpdateRectHeader header )
 {
 	switch( header.encoding )
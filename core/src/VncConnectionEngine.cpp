@@ -0,0 +1,879 @@
+/*
+ * VncConnectionEngine.cpp - implementation of VncConnectionEngine class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutexLocker>
+#include <QPair>
+#include <QtMath>
+#include <QRunnable>
+#include <QSet>
+#include <QThread>
+#include <QWaitCondition>
+
+#ifdef Q_OS_LINUX
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <winsock2.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#include "VeyonConfiguration.h"
+#include "VncConnectionEngine.h"
+#include "VeyonVncConnection.h"
+
+// clazy:excludeall=ctor-missing-parent-argument
+
+/*!
+ * \brief Waits for readable sockets and allows other threads to interrupt the wait
+ *
+ * On Linux an eventfd registered with epoll interrupts the wait. Other platforms poll the sockets
+ * along with a wake-up descriptor - a loopback UDP socket sending to itself on Windows (as WSAPoll()
+ * only supports sockets) and a pipe elsewhere.
+ */
+class VncConnectionPoller
+{
+public:
+	VncConnectionPoller()
+#ifdef Q_OS_LINUX
+		: m_epollFd( epoll_create1( EPOLL_CLOEXEC ) ),
+		m_eventFd( eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC ) )
+#elif defined(Q_OS_WIN)
+		: m_wakeUpSocket( INVALID_SOCKET ),
+		m_sockets(),
+		m_connections()
+#else
+		: m_wakeUpPipe{ -1, -1 },
+		m_sockets(),
+		m_connections()
+#endif
+	{
+#ifdef Q_OS_LINUX
+		if( m_epollFd < 0 || m_eventFd < 0 )
+		{
+			qCritical( "VncConnectionPoller: could not create epoll instance or event descriptor" );
+			return;
+		}
+
+		epoll_event event{};
+		event.events = EPOLLIN;
+		event.data.ptr = nullptr;
+		epoll_ctl( m_epollFd, EPOLL_CTL_ADD, m_eventFd, &event );
+#elif defined(Q_OS_WIN)
+		WSADATA wsaData;
+		WSAStartup( MAKEWORD( 2, 2 ), &wsaData );
+
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+		int addressLength = sizeof(address);
+		u_long nonBlocking = 1;
+
+		m_wakeUpSocket = socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
+
+		if( m_wakeUpSocket == INVALID_SOCKET ||
+				bind( m_wakeUpSocket, reinterpret_cast<sockaddr *>( &address ), addressLength ) != 0 ||
+				getsockname( m_wakeUpSocket, reinterpret_cast<sockaddr *>( &address ), &addressLength ) != 0 ||
+				::connect( m_wakeUpSocket, reinterpret_cast<sockaddr *>( &address ), addressLength ) != 0 ||
+				ioctlsocket( m_wakeUpSocket, FIONBIO, &nonBlocking ) != 0 )
+		{
+			qCritical( "VncConnectionPoller: could not create wake-up socket" );
+		}
+#else
+		if( pipe( m_wakeUpPipe ) != 0 )
+		{
+			qCritical( "VncConnectionPoller: could not create wake-up pipe" );
+			return;
+		}
+
+		for( auto fd : m_wakeUpPipe )
+		{
+			fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) | O_NONBLOCK );
+			fcntl( fd, F_SETFD, FD_CLOEXEC );
+		}
+#endif
+	}
+
+	~VncConnectionPoller()
+	{
+#ifdef Q_OS_LINUX
+		if( m_eventFd >= 0 )
+		{
+			::close( m_eventFd );
+		}
+		if( m_epollFd >= 0 )
+		{
+			::close( m_epollFd );
+		}
+#elif defined(Q_OS_WIN)
+		if( m_wakeUpSocket != INVALID_SOCKET )
+		{
+			closesocket( m_wakeUpSocket );
+		}
+
+		WSACleanup();
+#else
+		for( auto fd : m_wakeUpPipe )
+		{
+			if( fd >= 0 )
+			{
+				::close( fd );
+			}
+		}
+#endif
+	}
+
+	void add( int socket, VeyonVncConnection* connection )
+	{
+#ifdef Q_OS_LINUX
+		epoll_event event{};
+		event.events = EPOLLIN;
+		event.data.ptr = connection;
+		if( epoll_ctl( m_epollFd, EPOLL_CTL_ADD, socket, &event ) != 0 )
+		{
+			qWarning( "VncConnectionPoller::add(): could not add socket %d", socket );
+		}
+#else
+		m_sockets.append( socket );
+		m_connections.append( connection );
+#endif
+	}
+
+	void remove( int socket )
+	{
+#ifdef Q_OS_LINUX
+		epoll_event event{};
+		epoll_ctl( m_epollFd, EPOLL_CTL_DEL, socket, &event );
+#else
+		const auto index = m_sockets.indexOf( socket );
+		if( index >= 0 )
+		{
+			m_sockets.remove( index );
+			m_connections.remove( index );
+		}
+#endif
+	}
+
+	void wakeUp()
+	{
+		const char value = 1;
+
+#ifdef Q_OS_LINUX
+		const uint64_t counterValue = value;
+		if( ::write( m_eventFd, &counterValue, sizeof(counterValue) ) < 0 )
+		{
+			// counter overflow only - poller is woken up anyway
+		}
+#elif defined(Q_OS_WIN)
+		// fails only if the socket buffer is full in which case the poller is woken up anyway
+		send( m_wakeUpSocket, &value, sizeof(value), 0 );
+#else
+		if( ::write( m_wakeUpPipe[1], &value, sizeof(value) ) < 0 )
+		{
+			// pipe full only - poller is woken up anyway
+		}
+#endif
+	}
+
+	void wait( int timeout, QVector<VeyonVncConnection *>& readableConnections )
+	{
+		readableConnections.clear();
+
+#ifdef Q_OS_LINUX
+		epoll_event events[MaxEvents];
+		const int count = epoll_wait( m_epollFd, events, MaxEvents, timeout );
+
+		for( int i = 0; i < count; ++i )
+		{
+			if( events[i].data.ptr == nullptr )
+			{
+				uint64_t value = 0;
+				if( ::read( m_eventFd, &value, sizeof(value) ) < 0 )
+				{
+					// nothing to do - event descriptor was reset concurrently
+				}
+			}
+			else
+			{
+				readableConnections.append( static_cast<VeyonVncConnection *>( events[i].data.ptr ) );
+			}
+		}
+#else
+		// first descriptor is the wake-up descriptor
+		QVector<PollDescriptor> pollFds( m_sockets.size() + 1 );
+		pollFds[0].fd = wakeUpDescriptor();
+
+		for( int i = 0; i < m_sockets.size(); ++i )
+		{
+			pollFds[i+1].fd = static_cast<decltype(pollFds[i+1].fd)>( m_sockets[i] );
+		}
+
+		for( auto& pollFd : pollFds )
+		{
+			pollFd.events = PollReadEvents;
+			pollFd.revents = 0;
+		}
+
+		if( pollDescriptors( pollFds.data(), pollFds.size(), timeout ) > 0 )
+		{
+			if( pollFds[0].revents )
+			{
+				drainWakeUps();
+			}
+
+			for( int i = 0; i < m_sockets.size(); ++i )
+			{
+				if( pollFds[i+1].revents )
+				{
+					readableConnections.append( m_connections[i] );
+				}
+			}
+		}
+#endif
+	}
+
+private:
+#ifdef Q_OS_LINUX
+	enum {
+		MaxEvents = 64
+	};
+
+	int m_epollFd;
+	int m_eventFd;
+#else
+#ifdef Q_OS_WIN
+	typedef WSAPOLLFD PollDescriptor;
+
+	enum {
+		PollReadEvents = POLLRDNORM
+	};
+
+	SOCKET wakeUpDescriptor() const
+	{
+		return m_wakeUpSocket;
+	}
+
+	static int pollDescriptors( PollDescriptor* descriptors, int count, int timeout )
+	{
+		return WSAPoll( descriptors, static_cast<ULONG>( count ), timeout );
+	}
+
+	void drainWakeUps()
+	{
+		char buffer[64];
+		while( recv( m_wakeUpSocket, buffer, sizeof(buffer), 0 ) > 0 )
+		{
+		}
+	}
+
+	SOCKET m_wakeUpSocket;
+#else
+	typedef pollfd PollDescriptor;
+
+	enum {
+		PollReadEvents = POLLIN
+	};
+
+	int wakeUpDescriptor() const
+	{
+		return m_wakeUpPipe[0];
+	}
+
+	static int pollDescriptors( PollDescriptor* descriptors, int count, int timeout )
+	{
+		return ::poll( descriptors, static_cast<nfds_t>( count ), timeout );
+	}
+
+	void drainWakeUps()
+	{
+		char buffer[64];
+		while( ::read( m_wakeUpPipe[0], buffer, sizeof(buffer) ) > 0 )
+		{
+		}
+	}
+
+	int m_wakeUpPipe[2];
+#endif
+
+	QVector<int> m_sockets;
+	QVector<VeyonVncConnection *> m_connections;
+#endif
+
+} ;
+
+
+
+/*!
+ * \brief I/O thread handling a subset of all connections
+ */
+class VncConnectionEngineThread : public QThread
+{
+public:
+	explicit VncConnectionEngineThread( VncConnectionEngine* engine ) :
+		QThread(),
+		m_engine( engine ),
+		m_stopRequested( false )
+	{
+	}
+
+	VncConnectionEngine* engine() const
+	{
+		return m_engine;
+	}
+
+	int connectionCount()
+	{
+		QMutexLocker locker( &m_lock );
+		return m_attachedConnections.size();
+	}
+
+	void addConnection( VeyonVncConnection* connection )
+	{
+		QMutexLocker locker( &m_lock );
+		m_attachedConnections.insert( connection );
+		m_addedConnections.append( connection );
+		connection->m_engineThread.store( this );
+		m_poller.wakeUp();
+	}
+
+	void removeConnection( VeyonVncConnection* connection )
+	{
+		QMutexLocker locker( &m_lock );
+		while( m_attachedConnections.contains( connection ) )
+		{
+			m_pendingConnections.insert( connection );
+			m_poller.wakeUp();
+			m_connectionDetached.wait( &m_lock );
+		}
+	}
+
+	void wakeUp( VeyonVncConnection* connection )
+	{
+		QMutexLocker locker( &m_lock );
+		m_pendingConnections.insert( connection );
+		m_poller.wakeUp();
+	}
+
+	void finishHandshake( VeyonVncConnection* connection, bool connected )
+	{
+		QMutexLocker locker( &m_lock );
+		m_finishedHandshakes.append( qMakePair( connection, connected ) );
+		m_poller.wakeUp();
+	}
+
+	void stop()
+	{
+		QMutexLocker locker( &m_lock );
+		m_stopRequested = true;
+		m_poller.wakeUp();
+	}
+
+
+protected:
+	void run() override
+	{
+		m_clock.start();
+
+		QVector<VeyonVncConnection *> readableConnections;
+
+		while( processPendingChanges() )
+		{
+			const auto now = m_clock.elapsed();
+			qint64 nextDeadline = -1;
+
+			for( auto it = m_connections.begin(); it != m_connections.end(); ++it )
+			{
+				if( it->deadline >= 0 && it->deadline <= now )
+				{
+					processDeadline( it.key(), *it );
+				}
+
+				if( it->deadline >= 0 && ( nextDeadline < 0 || it->deadline < nextDeadline ) )
+				{
+					nextDeadline = it->deadline;
+				}
+			}
+
+			m_poller.wait( nextDeadline < 0 ? -1 : static_cast<int>( qMax<qint64>( 0, nextDeadline - m_clock.elapsed() ) ),
+						   readableConnections );
+
+			for( auto connection : qAsConst(readableConnections) )
+			{
+				auto it = m_connections.find( connection );
+				if( it != m_connections.end() && it->phase == Entry::Running )
+				{
+					handleReadableConnection( connection, *it );
+				}
+			}
+		}
+
+		// shut down all remaining connections
+		for( auto it = m_connections.begin(); it != m_connections.end(); ++it )
+		{
+			if( it->phase == Entry::Running )
+			{
+				m_poller.remove( it->socket );
+				it.key()->closeConnection();
+			}
+			detach( it.key() );
+		}
+
+		m_connections.clear();
+	}
+
+
+private:
+	struct Entry
+	{
+		enum Phase {
+			Idle,
+			Handshaking,
+			Running
+		} phase;
+		qint64 deadline;
+		int socket;
+	} ;
+
+	bool processPendingChanges()
+	{
+		m_lock.lock();
+
+		const auto addedConnections = m_addedConnections;
+		const auto finishedHandshakes = m_finishedHandshakes;
+		auto pendingConnections = m_pendingConnections;
+		const auto stopRequested = m_stopRequested;
+
+		m_addedConnections.clear();
+		m_finishedHandshakes.clear();
+		m_pendingConnections.clear();
+
+		m_lock.unlock();
+
+		for( auto connection : addedConnections )
+		{
+			m_connections[connection] = { Entry::Idle, m_clock.elapsed(), -1 };
+		}
+
+		for( const auto& handshake : finishedHandshakes )
+		{
+			auto it = m_connections.find( handshake.first );
+			if( it == m_connections.end() )
+			{
+				continue;
+			}
+
+			if( handshake.second && handshake.first->isStopRequested() == false )
+			{
+				it->phase = Entry::Running;
+				it->socket = handshake.first->socketDescriptor();
+				it->deadline = m_clock.elapsed();
+				m_poller.add( it->socket, handshake.first );
+			}
+			else
+			{
+				if( handshake.second )
+				{
+					handshake.first->closeConnection();
+				}
+				it->phase = Entry::Idle;
+				it->deadline = m_clock.elapsed() + handshake.first->reconnectInterval();
+			}
+
+			if( handshake.first->isStopRequested() )
+			{
+				pendingConnections.insert( handshake.first );
+			}
+		}
+
+		if( stopRequested )
+		{
+			for( auto it = m_connections.constBegin(); it != m_connections.constEnd(); ++it )
+			{
+				pendingConnections.insert( it.key() );
+			}
+		}
+
+		for( auto connection : qAsConst(pendingConnections) )
+		{
+			auto it = m_connections.find( connection );
+			if( it == m_connections.end() )
+			{
+				continue;
+			}
+
+			if( connection->isStopRequested() || stopRequested )
+			{
+				if( it->phase == Entry::Handshaking )
+				{
+					// handshake can't be interrupted so wait for finishHandshake()
+					continue;
+				}
+
+				if( it->phase == Entry::Running )
+				{
+					connection->sendEvents();
+					m_poller.remove( it->socket );
+					connection->closeConnection();
+				}
+
+				m_connections.erase( it );
+				detach( connection );
+			}
+			else if( it->phase == Entry::Running )
+			{
+				connection->sendEvents();
+				if( connection->isUpdateRequestDue() )
+				{
+					it->deadline = m_clock.elapsed();
+				}
+			}
+			else if( it->phase == Entry::Idle && connection->isReconnectDue() )
+			{
+				it->deadline = m_clock.elapsed();
+			}
+		}
+
+		if( stopRequested )
+		{
+			// stop as soon as there are no more handshakes to wait for
+			for( const auto& entry : qAsConst(m_connections) )
+			{
+				if( entry.phase == Entry::Handshaking )
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		return true;
+	}
+
+	void processDeadline( VeyonVncConnection* connection, Entry& entry )
+	{
+		switch( entry.phase )
+		{
+		case Entry::Idle:
+		{
+			const auto retryDelay = m_engine->admitHandshake( connection );
+			if( retryDelay > 0 )
+			{
+				entry.deadline = m_clock.elapsed() + retryDelay;
+				break;
+			}
+
+			entry.phase = Entry::Handshaking;
+			entry.deadline = -1;
+			m_engine->handshakeThreadPool().start( new Handshake( this, connection ) );
+			break;
+		}
+
+		case Entry::Running:
+		{
+			const auto nextUpdate = connection->handleUpdateTimer();
+			if( nextUpdate < 0 )
+			{
+				m_poller.remove( entry.socket );
+				connection->closeConnection();
+				entry.phase = Entry::Idle;
+			}
+			entry.deadline = m_clock.elapsed() + qMax( 0, nextUpdate );
+			break;
+		}
+
+		default:
+			break;
+		}
+	}
+
+	void handleReadableConnection( VeyonVncConnection* connection, Entry& entry )
+	{
+		if( connection->handleServerMessages() == false )
+		{
+			m_poller.remove( entry.socket );
+			connection->closeConnection();
+
+			// reconnect immediately
+			entry.phase = Entry::Idle;
+			entry.deadline = m_clock.elapsed();
+		}
+		else if( connection->isUpdateRequestDue() )
+		{
+			entry.deadline = m_clock.elapsed();
+		}
+	}
+
+	void detach( VeyonVncConnection* connection )
+	{
+		m_engine->forgetConnection( connection );
+
+		connection->finishEngineProcessing();
+
+		QMutexLocker locker( &m_lock );
+		m_attachedConnections.remove( connection );
+		m_pendingConnections.remove( connection );
+		connection->m_engineThread.store( nullptr );
+		connection->m_running.storeRelease( 0 );
+		m_connectionDetached.wakeAll();
+	}
+
+	class Handshake : public QRunnable
+	{
+	public:
+		Handshake( VncConnectionEngineThread* thread, VeyonVncConnection* connection ) :
+			m_thread( thread ),
+			m_connection( connection )
+		{
+		}
+
+		void run() override
+		{
+			QElapsedTimer connectTimer;
+			connectTimer.start();
+
+			const auto connected = m_connection->establishConnection();
+
+			m_thread->engine()->finishHandshake();
+
+			if( connected )
+			{
+				m_connection->m_connectLatency.storeRelease( static_cast<int>( connectTimer.elapsed() ) );
+				qDebug() << "VncConnectionEngine: connected to" << m_connection->host()
+						 << "within" << connectTimer.elapsed() << "ms";
+			}
+
+			m_thread->finishHandshake( m_connection, connected );
+		}
+
+	private:
+		VncConnectionEngineThread* m_thread;
+		VeyonVncConnection* m_connection;
+	} ;
+
+	VncConnectionEngine* m_engine;
+	VncConnectionPoller m_poller;
+	QElapsedTimer m_clock;
+
+	QMutex m_lock;
+	QWaitCondition m_connectionDetached;
+	QSet<VeyonVncConnection *> m_attachedConnections;
+	QVector<VeyonVncConnection *> m_addedConnections;
+	QVector<QPair<VeyonVncConnection *, bool> > m_finishedHandshakes;
+	QSet<VeyonVncConnection *> m_pendingConnections;
+	bool m_stopRequested;
+
+	// only accessed from within I/O thread
+	QHash<VeyonVncConnection *, Entry> m_connections;
+
+} ;
+
+
+
+VncConnectionEngine::VncConnectionEngine( QObject* parent ) :
+	QObject( parent ),
+	m_threadsLock(),
+	m_threads(),
+	m_handshakeThreadPool( this ),
+	m_admissionLock(),
+	m_maximumConcurrentHandshakes( 1 ),
+	m_handshakesPerSecond( 1 ),
+	m_activeHandshakes( 0 ),
+	m_handshakeTokens( 0 ),
+	m_handshakeTokenClock(),
+	m_waitingPrioritizedConnections(),
+	m_bandwidthScheduler()
+{
+	m_handshakeThreadPool.setMaxThreadCount( HandshakeThreadCount );
+}
+
+
+
+VncConnectionEngine::~VncConnectionEngine()
+{
+	QMutexLocker locker( &m_threadsLock );
+
+	for( auto thread : qAsConst(m_threads) )
+	{
+		thread->stop();
+	}
+
+	for( auto thread : qAsConst(m_threads) )
+	{
+		thread->wait();
+		delete thread;
+	}
+
+	m_threads.clear();
+
+	m_handshakeThreadPool.waitForDone();
+}
+
+
+
+void VncConnectionEngine::addConnection( VeyonVncConnection* connection )
+{
+	QMutexLocker locker( &m_threadsLock );
+
+	// start I/O threads on demand only so processes not using any VNC connections are not affected
+	if( m_threads.isEmpty() )
+	{
+		startThreads();
+	}
+
+	// assign connection to least loaded thread
+	auto thread = m_threads.first();
+	auto connectionCount = thread->connectionCount();
+
+	for( auto otherThread : qAsConst(m_threads) )
+	{
+		const auto otherConnectionCount = otherThread->connectionCount();
+		if( otherConnectionCount < connectionCount )
+		{
+			thread = otherThread;
+			connectionCount = otherConnectionCount;
+		}
+	}
+
+	thread->addConnection( connection );
+}
+
+
+
+void VncConnectionEngine::removeConnection( VeyonVncConnection* connection )
+{
+	auto thread = connection->m_engineThread.load();
+	if( thread )
+	{
+		thread->removeConnection( connection );
+	}
+}
+
+
+
+int VncConnectionEngine::admitHandshake( VeyonVncConnection* connection )
+{
+	QMutexLocker locker( &m_admissionLock );
+
+	// refill token bucket
+	m_handshakeTokens = qMin<double>( m_maximumConcurrentHandshakes,
+									  m_handshakeTokens + m_handshakeTokenClock.restart() * m_handshakesPerSecond / 1000.0 );
+
+	const auto prioritized = connection->areFramebufferUpdatesPaused() == false;
+	if( prioritized == false )
+	{
+		m_waitingPrioritizedConnections.remove( connection );
+
+		if( m_waitingPrioritizedConnections.isEmpty() == false )
+		{
+			return AdmissionRetryInterval;
+		}
+	}
+
+	int retryDelay = 0;
+
+	if( m_activeHandshakes >= m_maximumConcurrentHandshakes )
+	{
+		retryDelay = AdmissionRetryInterval;
+	}
+	else if( m_handshakeTokens < 1 )
+	{
+		retryDelay = qMax( 1, qCeil( ( 1 - m_handshakeTokens ) * 1000 / m_handshakesPerSecond ) );
+	}
+
+	if( retryDelay > 0 )
+	{
+		if( prioritized )
+		{
+			m_waitingPrioritizedConnections.insert( connection );
+		}
+		return retryDelay;
+	}
+
+	m_waitingPrioritizedConnections.remove( connection );
+	m_handshakeTokens -= 1;
+	++m_activeHandshakes;
+
+	return 0;
+}
+
+
+
+void VncConnectionEngine::finishHandshake()
+{
+	QMutexLocker locker( &m_admissionLock );
+	--m_activeHandshakes;
+}
+
+
+
+void VncConnectionEngine::forgetConnection( VeyonVncConnection* connection )
+{
+	m_admissionLock.lock();
+	m_waitingPrioritizedConnections.remove( connection );
+	m_admissionLock.unlock();
+
+	m_bandwidthScheduler.removeConnection( connection );
+}
+
+
+
+void VncConnectionEngine::startThreads()
+{
+	m_admissionLock.lock();
+	m_maximumConcurrentHandshakes = qMax( 1, VeyonCore::config().maximumConcurrentConnectionAttempts() );
+	m_handshakesPerSecond = qMax( 1, VeyonCore::config().connectionAttemptsPerSecond() );
+	m_handshakeTokens = m_maximumConcurrentHandshakes;
+	m_handshakeTokenClock.start();
+	m_admissionLock.unlock();
+
+	m_bandwidthScheduler.setBandwidth( qint64( qMax( 0, VeyonCore::config().maximumIngressBandwidth() ) ) * 1000 * 1000 / 8 );
+
+	const auto threadCount = qBound<int>( 1, QThread::idealThreadCount(), MaximumThreadCount );
+
+	for( int i = 0; i < threadCount; ++i )
+	{
+		auto thread = new VncConnectionEngineThread( this );
+		thread->setObjectName( QStringLiteral("VncConnectionEngine-%1").arg( i ) );
+		thread->start();
+		m_threads.append( thread );
+	}
+
+	qDebug() << "VncConnectionEngine: started" << threadCount << "I/O threads";
+}
+
+
+
+void VncConnectionEngine::wakeUp( VeyonVncConnection* connection )
+{
+	auto thread = connection->m_engineThread.load();
+	if( thread )
+	{
+		thread->wakeUp( connection );
+	}
+}
@@ -0,0 +1,272 @@
+/*
+ * VncConnectionStatistics.cpp - implementation of VncConnectionStatistics class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QMutexLocker>
+
+#ifdef Q_OS_LINUX
+#include <cstddef>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <linux/tcp.h>
+#elif defined(Q_OS_WIN)
+#include <winsock2.h>
+#include <mstcpip.h>
+#endif
+
+#include "VncConnectionStatistics.h"
+
+
+VncConnectionStatistics::Histogram::Histogram() :
+	m_buckets(),
+	m_count( 0 ),
+	m_sum( 0 ),
+	m_maximum( 0 )
+{
+}
+
+
+
+void VncConnectionStatistics::Histogram::record( qint64 value )
+{
+	value = qMax<qint64>( 0, value );
+
+	// bucket N holds values in range [2^(N-1), 2^N)
+	int bucket = 0;
+	while( bucket < BucketCount-1 && ( value >> bucket ) > 0 )
+	{
+		++bucket;
+	}
+
+	++m_buckets[bucket];
+	++m_count;
+	m_sum += value;
+	m_maximum = qMax( m_maximum, value );
+}
+
+
+
+qint64 VncConnectionStatistics::Histogram::percentile( int percent ) const
+{
+	const auto threshold = ( m_count * percent + 99 ) / 100;
+
+	qint64 count = 0;
+	for( int bucket = 0; bucket < BucketCount; ++bucket )
+	{
+		count += m_buckets[bucket];
+		if( count >= threshold && count > 0 )
+		{
+			return qMin( m_maximum, ( Q_INT64_C(1) << bucket ) - 1 );
+		}
+	}
+
+	return m_maximum;
+}
+
+
+
+QJsonObject VncConnectionStatistics::Histogram::toJson() const
+{
+	return QJsonObject( {
+							{ QStringLiteral("count"), m_count },
+							{ QStringLiteral("average"), average() },
+							{ QStringLiteral("p50"), percentile( 50 ) },
+							{ QStringLiteral("p90"), percentile( 90 ) },
+							{ QStringLiteral("p99"), percentile( 99 ) },
+							{ QStringLiteral("maximum"), m_maximum }
+						} );
+}
+
+
+
+VncConnectionStatistics::VncConnectionStatistics() :
+	m_mutex(),
+	m_rateTimer(),
+	m_windowUpdateCount( 0 ),
+	m_updatesPerSecond( 0 ),
+	m_updateCount( 0 ),
+	m_totalBytes( 0 ),
+	m_updateBytes(),
+	m_updateLatency(),
+	m_scaleTime(),
+	m_decodeTimes()
+{
+}
+
+
+
+void VncConnectionStatistics::reset()
+{
+	QMutexLocker locker( &m_mutex );
+
+	m_rateTimer.invalidate();
+	m_windowUpdateCount = 0;
+	m_updatesPerSecond = 0;
+	m_updateCount = 0;
+	m_totalBytes = 0;
+	m_updateBytes = Histogram();
+	m_updateLatency = Histogram();
+	m_scaleTime = Histogram();
+	m_decodeTimes.clear();
+}
+
+
+
+void VncConnectionStatistics::recordUpdate( qint64 bytes, qint64 latency, const QString& encoding, qint64 decodeTime )
+{
+	QMutexLocker locker( &m_mutex );
+
+	if( m_rateTimer.isValid() == false )
+	{
+		m_rateTimer.start();
+	}
+
+	++m_windowUpdateCount;
+	if( m_rateTimer.elapsed() >= RateWindow )
+	{
+		m_updatesPerSecond = m_windowUpdateCount * 1000.0 / m_rateTimer.restart();
+		m_windowUpdateCount = 0;
+	}
+
+	++m_updateCount;
+
+	if( bytes >= 0 )
+	{
+		m_totalBytes += bytes;
+		m_updateBytes.record( bytes );
+	}
+
+	if( latency >= 0 )
+	{
+		m_updateLatency.record( latency );
+	}
+
+	m_decodeTimes[encoding].record( decodeTime );
+}
+
+
+
+void VncConnectionStatistics::recordScaling( qint64 scaleTime )
+{
+	QMutexLocker locker( &m_mutex );
+	m_scaleTime.record( scaleTime );
+}
+
+
+
+double VncConnectionStatistics::updatesPerSecond() const
+{
+	QMutexLocker locker( &m_mutex );
+	return currentUpdatesPerSecond();
+}
+
+
+
+QJsonObject VncConnectionStatistics::toJson() const
+{
+	QMutexLocker locker( &m_mutex );
+
+	QJsonObject decodeTimes;
+	for( auto it = m_decodeTimes.constBegin(); it != m_decodeTimes.constEnd(); ++it )
+	{
+		decodeTimes[it.key()] = it.value().toJson();
+	}
+
+	return QJsonObject( {
+							{ QStringLiteral("updatesPerSecond"), currentUpdatesPerSecond() },
+							{ QStringLiteral("updateCount"), m_updateCount },
+							{ QStringLiteral("totalBytes"), m_totalBytes },
+							{ QStringLiteral("updateBytes"), m_updateBytes.toJson() },
+							{ QStringLiteral("updateLatency"), m_updateLatency.toJson() },
+							{ QStringLiteral("decodeTime"), decodeTimes },
+							{ QStringLiteral("scaleTime"), m_scaleTime.toJson() }
+						} );
+}
+
+
+
+QString VncConnectionStatistics::summary() const
+{
+	QMutexLocker locker( &m_mutex );
+
+	qint64 decodeTime = 0;
+	qint64 decodeCount = 0;
+	for( const auto& histogram : m_decodeTimes )
+	{
+		decodeTime += histogram.average() * histogram.count();
+		decodeCount += histogram.count();
+	}
+
+	return QStringLiteral( "%1 upd/s | %2 KB | lat %3 ms | dec %4 ms | scale %5 ms" ).
+			arg( currentUpdatesPerSecond(), 0, 'f', 1 ).
+			arg( m_updateBytes.average() / 1024 ).
+			arg( m_updateLatency.average() / 1000 ).
+			arg( decodeCount > 0 ? decodeTime / decodeCount / 1000 : 0 ).
+			arg( m_scaleTime.average() / 1000 );
+}
+
+
+
+qint64 VncConnectionStatistics::socketBytesReceived( int socket )
+{
+#ifdef Q_OS_LINUX
+	tcp_info info{};
+	socklen_t infoLength = sizeof(info);
+
+	if( socket >= 0 &&
+			getsockopt( socket, IPPROTO_TCP, TCP_INFO, &info, &infoLength ) == 0 &&
+			infoLength >= offsetof( tcp_info, tcpi_bytes_received ) + sizeof(info.tcpi_bytes_received) )
+	{
+		return static_cast<qint64>( info.tcpi_bytes_received );
+	}
+#elif defined(Q_OS_WIN) && defined(SIO_TCP_INFO)
+	// available since Windows 10 1703
+	DWORD version = 0;
+	TCP_INFO_v0 info{};
+	DWORD infoLength = 0;
+
+	if( socket >= 0 &&
+			WSAIoctl( static_cast<SOCKET>( socket ), SIO_TCP_INFO, &version, sizeof(version),
+					  &info, sizeof(info), &infoLength, nullptr, nullptr ) == 0 )
+	{
+		return static_cast<qint64>( info.BytesIn );
+	}
+#else
+	Q_UNUSED(socket)
+#endif
+
+	return -1;
+}
+
+
+
+double VncConnectionStatistics::currentUpdatesPerSecond() const
+{
+	// decay rate if no updates have been recorded for a while
+	if( m_rateTimer.isValid() && m_rateTimer.elapsed() >= RateWindow * 2 )
+	{
+		return m_windowUpdateCount * 1000.0 / m_rateTimer.elapsed();
+	}
+
+	return m_updatesPerSecond;
+}
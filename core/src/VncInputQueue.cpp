@@ -0,0 +1,188 @@
+/*
+ * VncInputQueue.cpp - implementation of VncInputQueue class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "VncInputQueue.h"
+
+
+VncInputQueue::VncInputQueue() :
+	m_events(),
+	m_head( 0 ),
+	m_tail( 0 ),
+	m_enqueuedButtonMask( 0 ),
+	m_buttonMask( 0 ),
+	m_overflowLock(),
+	m_overflowEvents(),
+	m_lastOverflowEventIsMove( false ),
+	m_overflowing( 0 )
+{
+	static_assert( ( Capacity & ( Capacity - 1 ) ) == 0, "capacity has to be a power of two" );
+}
+
+
+
+bool VncInputQueue::enqueuePointerEvent( int x, int y, int buttonMask )
+{
+	return enqueue( { Event::Pointer, x, y, buttonMask, 0, false } );
+}
+
+
+
+bool VncInputQueue::enqueueKeyEvent( unsigned int key, bool pressed )
+{
+	return enqueue( { Event::Key, 0, 0, 0, key, pressed } );
+}
+
+
+
+int VncInputQueue::drain( QVector<Event>& events )
+{
+	events.clear();
+
+	bool lastEventIsMove = false;
+
+	if( m_overflowing.loadAcquire() )
+	{
+		// the producer waits for the lock meanwhile so all events in the ring precede the overflow events
+		QMutexLocker locker( &m_overflowLock );
+
+		takeRingEvents( events, lastEventIsMove );
+
+		for( const auto& event : qAsConst(m_overflowEvents) )
+		{
+			appendEvent( events, event, lastEventIsMove );
+		}
+
+		m_overflowEvents.clear();
+		m_lastOverflowEventIsMove = false;
+		m_overflowing.storeRelease( 0 );
+	}
+	else
+	{
+		takeRingEvents( events, lastEventIsMove );
+	}
+
+	return events.count();
+}
+
+
+
+void VncInputQueue::clear()
+{
+	QMutexLocker locker( &m_overflowLock );
+
+	m_tail.storeRelease( m_head.loadAcquire() );
+
+	m_overflowEvents.clear();
+	m_lastOverflowEventIsMove = false;
+	m_overflowing.storeRelease( 0 );
+
+	m_buttonMask = 0;
+}
+
+
+
+bool VncInputQueue::enqueue( const Event& event )
+{
+	const auto isMove = event.type == Event::Pointer && event.buttonMask == m_enqueuedButtonMask;
+	if( event.type == Event::Pointer )
+	{
+		m_enqueuedButtonMask = event.buttonMask;
+	}
+
+	const auto head = m_head.load();
+
+	if( m_overflowing.loadAcquire() == 0 &&
+			head - m_tail.loadAcquire() < static_cast<quint32>( Capacity ) )
+	{
+		m_events[head % Capacity] = event;
+		m_head.storeRelease( head + 1 );
+
+		return true;
+	}
+
+	// ring is full so keep events in order by using the overflow list until the consumer has caught up
+	QMutexLocker locker( &m_overflowLock );
+
+	if( m_overflowEvents.isEmpty() )
+	{
+		qWarning( "VncInputQueue::enqueue(): queue full - using overflow list" );
+	}
+
+	// drop previous pointer move but never the event which changed the button state
+	if( isMove && m_lastOverflowEventIsMove )
+	{
+		m_overflowEvents.last() = event;
+	}
+	else
+	{
+		m_overflowEvents.append( event );
+	}
+
+	m_lastOverflowEventIsMove = isMove;
+	m_overflowing.storeRelease( 1 );
+
+	return true;
+}
+
+
+
+void VncInputQueue::takeRingEvents( QVector<Event>& events, bool& lastEventIsMove )
+{
+	const auto head = m_head.loadAcquire();
+	auto tail = m_tail.load();
+
+	for( ; tail != head; ++tail )
+	{
+		appendEvent( events, m_events[tail % Capacity], lastEventIsMove );
+	}
+
+	m_tail.storeRelease( tail );
+}
+
+
+
+void VncInputQueue::appendEvent( QVector<Event>& events, const Event& event, bool& lastEventIsMove )
+{
+	if( event.type != Event::Pointer )
+	{
+		events.append( event );
+		lastEventIsMove = false;
+		return;
+	}
+
+	const auto isMove = event.buttonMask == m_buttonMask;
+	m_buttonMask = event.buttonMask;
+
+	// replace previous pointer move but never the event which changed the button state
+	if( isMove && lastEventIsMove )
+	{
+		events.last() = event;
+	}
+	else
+	{
+		events.append( event );
+	}
+
+	lastEventIsMove = isMove;
+}
@@ -0,0 +1,178 @@
+/*
+ * VncQualityController.cpp - implementation of VncQualityController class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <cstring>
+
+#include "VncQualityController.h"
+
+
+VncQualityController::VncQualityController() :
+	m_enabled( true ),
+	m_bounds( { 9, 9, 0, 0, 1, 0, "raw", "raw", false } ),
+	m_baseUpdateInterval( 0 ),
+	m_settings( { 9, 0, 0, "raw", false } ),
+	m_step( 0 ),
+	m_windowTimer(),
+	m_sampleCount( 0 ),
+	m_windowTransferTime( 0 ),
+	m_windowBytes( 0 ),
+	m_throughput( 0 ),
+	m_fastWindowCount( 0 )
+{
+}
+
+
+
+void VncQualityController::reset( const Bounds& bounds, int baseUpdateInterval )
+{
+	m_bounds = bounds;
+	m_baseUpdateInterval = baseUpdateInterval;
+	m_step.storeRelease( 0 );
+
+	m_windowTimer.invalidate();
+	m_sampleCount = 0;
+	m_windowTransferTime = 0;
+	m_windowBytes = 0;
+	m_throughput = 0;
+	m_fastWindowCount = 0;
+
+	updateSettings();
+}
+
+
+
+bool VncQualityController::setBounds( const Bounds& bounds, int baseUpdateInterval )
+{
+	const auto previousSettings = m_settings;
+
+	m_bounds = bounds;
+	m_baseUpdateInterval = baseUpdateInterval;
+
+	updateSettings();
+
+	return m_settings.qualityLevel != previousSettings.qualityLevel ||
+			m_settings.compressLevel != previousSettings.compressLevel ||
+			m_settings.updateInterval != previousSettings.updateInterval ||
+			m_settings.enableJPEG != previousSettings.enableJPEG ||
+			strcmp( m_settings.encodings, previousSettings.encodings ) != 0;
+}
+
+
+
+void VncQualityController::recordUpdate( qint64 bytes, qint64 transferTime )
+{
+	if( m_windowTimer.isValid() == false )
+	{
+		m_windowTimer.start();
+	}
+
+	++m_sampleCount;
+	m_windowTransferTime += transferTime;
+
+	if( bytes > 0 )
+	{
+		m_windowBytes += bytes;
+	}
+}
+
+
+
+bool VncQualityController::adjust()
+{
+	if( m_enabled == false || m_bounds.targetTransferTime <= 0 ||
+			m_windowTimer.isValid() == false || m_windowTimer.elapsed() < AdjustmentInterval ||
+			m_sampleCount < MinimumSampleCount )
+	{
+		// keep collecting samples, e.g. while the screen does not change
+		return false;
+	}
+
+	const auto averageTransferTime = m_windowTransferTime / m_sampleCount / 1000;
+
+	if( m_windowBytes > 0 && m_windowTransferTime > 0 )
+	{
+		const auto windowThroughput = m_windowBytes * 1000000 / m_windowTransferTime;
+		m_throughput = m_throughput > 0 ? ( m_throughput * 3 + windowThroughput ) / 4 : windowThroughput;
+	}
+
+	m_windowTimer.restart();
+	m_sampleCount = 0;
+	m_windowTransferTime = 0;
+	m_windowBytes = 0;
+
+	const auto previousStep = m_step.loadAcquire();
+	auto step = previousStep;
+
+	if( averageTransferTime > m_bounds.targetTransferTime )
+	{
+		// degrade quickly so the link does not stay saturated
+		step = qMin<int>( step + 1, StepCount - 1 );
+		m_fastWindowCount = 0;
+	}
+	else if( averageTransferTime * 2 < m_bounds.targetTransferTime )
+	{
+		// recover slowly unless the link obviously has plenty of capacity
+		++m_fastWindowCount;
+		if( m_fastWindowCount >= RecoveryWindowCount || m_throughput >= FastLinkThroughput )
+		{
+			step = qMax( step - 1, 0 );
+			m_fastWindowCount = 0;
+		}
+	}
+	else
+	{
+		m_fastWindowCount = 0;
+	}
+
+	if( step == previousStep )
+	{
+		return false;
+	}
+
+	m_step.storeRelease( step );
+	updateSettings();
+
+	return true;
+}
+
+
+
+void VncQualityController::updateSettings()
+{
+	const auto step = m_step.loadAcquire();
+
+	m_settings.qualityLevel = interpolate( m_bounds.maximumQualityLevel, m_bounds.minimumQualityLevel, step );
+	m_settings.compressLevel = interpolate( m_bounds.minimumCompressLevel, m_bounds.maximumCompressLevel, step );
+	m_settings.updateInterval = interpolate( m_baseUpdateInterval,
+											 m_baseUpdateInterval * m_bounds.maximumUpdateIntervalFactor, step );
+	m_settings.encodings = step > 0 ? m_bounds.constrainedEncodings : m_bounds.encodings;
+	m_settings.enableJPEG = m_bounds.lossyEncodingAllowed;
+}
+
+
+
+int VncQualityController::interpolate( int best, int worst, int step )
+{
+	return best + ( worst - best ) * step / ( StepCount - 1 );
+}
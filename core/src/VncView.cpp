@@ -25,6 +25,7 @@
 #define XK_KOREAN
 #include "rfb/keysym.h"
 
+#include "FramebufferScaler.h"
 #include "VncView.h"
 #include "PlatformInputDeviceFunctions.h"
 #include "KeyboardShortcutTrapper.h"
@@ -45,6 +46,8 @@ VncView::VncView( const QString &host, int port, QWidget *parent, Mode mode ) :
 	m_cursorX( 0 ),
 	m_cursorY( 0 ),
 	m_framebufferSize( 0, 0 ),
+	m_scaledImage(),
+	m_scaledImageDamage(),
 	m_cursorHotX( 0 ),
 	m_cursorHotY( 0 ),
 	m_viewOnly( true ),
@@ -590,6 +593,30 @@ QRect VncView::mapFromFramebuffer( QRect r )
 
 
 
+void VncView::updateScaledImage( const QImage& image )
+{
+	const auto size = scaledSize();
+
+	if( m_scaledImage.size() != size || m_scaledImage.format() != image.format() ||
+			FramebufferScaler::canScale( image, size ) == false )
+	{
+		m_scaledImage = FramebufferScaler::scaled( image, size );
+	}
+	else
+	{
+		// only rescale areas which have been updated since last paint
+		const auto rects = m_scaledImageDamage.rects();
+		for( const auto& rect : rects )
+		{
+			FramebufferScaler::scale( image, m_scaledImage, FramebufferScaler::mapToTarget( rect, image.size(), size ) );
+		}
+	}
+
+	m_scaledImageDamage = QRegion();
+}
+
+
+
 void VncView::updateLocalCursor()
 {
 	if( isViewOnly()  )
@@ -664,11 +691,14 @@ void VncView::paintEvent( QPaintEvent *paintEvent )
 
 	if( isScaledView() )
 	{
-		// repaint everything in scaled mode to avoid artifacts at rectangle boundaries
-		p.drawImage( QRect( QPoint( 0, 0 ), scaledSize() ), image );
+		updateScaledImage( image );
+		p.drawImage( 0, 0, m_scaledImage );
 	}
 	else
 	{
+		m_scaledImage = QImage();
+		m_scaledImageDamage = QRegion();
+
 		p.drawImage( 0, 0, image );
 	}
 
@@ -795,6 +825,8 @@ void VncView::updateImage( int x, int y, int w, int h )
 
 	}
 
+	m_scaledImageDamage += QRect( x, y, w, h );
+
 	const auto scale = scaleFactor();
 
 	update( qMax( 0, qFloor( x*scale - 1 ) ), qMax( 0, qFloor( y*scale - 1 ) ),
@@ -807,6 +839,8 @@ void VncView::updateFramebufferSize( int w, int h )
 {
 	m_framebufferSize = QSize( w, h );
 
+	m_scaledImage = QImage();
+
 	resize( w, h );
 
 	emit sizeHintChanged();
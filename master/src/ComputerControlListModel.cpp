@@ -22,12 +22,21 @@
  *
  */
 
+#include <QDir>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QJsonArray>
+#include <QJsonDocument>
 #include <QPainter>
 #include <QTimer>
+#include <QtConcurrent>
 
 #include "ComputerControlListModel.h"
 #include "ComputerManager.h"
 #include "FeatureManager.h"
+#include "Filesystem.h"
+#include "FramebufferActivityDetector.h"
+#include "FramebufferPool.h"
 #include "VeyonMaster.h"
 #include "UserConfig.h"
 #include "VeyonConfiguration.h"
@@ -37,9 +46,15 @@ ComputerControlListModel::ComputerControlListModel( VeyonMaster* masterCore, QOb
 	QAbstractListModel( parent ),
 	m_master( masterCore ),
 	m_displayRoleContent( static_cast<DisplayRoleContent>( VeyonCore::config().computerDisplayRoleContent() ) ),
+	m_connectionStatisticsEnabled( VeyonCore::config().connectionStatisticsEnabled() ),
+	m_thumbnailCacheEnabled( VeyonCore::config().thumbnailCacheEnabled() ),
 	m_iconDefault(),
 	m_iconConnectionProblem(),
-	m_iconDemoMode()
+	m_iconDemoMode(),
+	m_thumbnailCache(),
+	m_cachedThumbnails(),
+	m_storedScreenGenerations(),
+	m_thumbnailStoreFuture()
 {
 	loadIcons();
 
@@ -52,11 +67,37 @@ ComputerControlListModel::ComputerControlListModel( VeyonMaster* masterCore, QOb
 	connect( computerScreenUpdateTimer, &QTimer::timeout, this, &ComputerControlListModel::updateComputerScreens );
 	computerScreenUpdateTimer->start( VeyonCore::config().computerMonitoringUpdateInterval() );
 
+	if( m_connectionStatisticsEnabled )
+	{
+		auto connectionStatisticsDumpTimer = new QTimer( this );
+		connect( connectionStatisticsDumpTimer, &QTimer::timeout, this, &ComputerControlListModel::dumpConnectionStatistics );
+		connectionStatisticsDumpTimer->start( ConnectionStatisticsDumpInterval );
+	}
+
+	if( m_thumbnailCacheEnabled )
+	{
+		auto thumbnailStoreTimer = new QTimer( this );
+		connect( thumbnailStoreTimer, &QTimer::timeout, this, &ComputerControlListModel::storeThumbnails );
+		thumbnailStoreTimer->start( ThumbnailStoreInterval );
+	}
+
 	reload();
 }
 
 
 
+ComputerControlListModel::~ComputerControlListModel()
+{
+	m_thumbnailStoreFuture.waitForFinished();
+
+	if( m_thumbnailCacheEnabled )
+	{
+		m_thumbnailCache.store( changedThumbnails() );
+	}
+}
+
+
+
 int ComputerControlListModel::rowCount( const QModelIndex& parent ) const
 {
 	if( parent.isValid() )
@@ -100,6 +141,12 @@ QVariant ComputerControlListModel::data( const QModelIndex& index, int role ) co
 	case UidRole:
 		return computerControl->computer().networkObjectUid();
 
+	case ScreenActivityRole:
+		return computerControl->screenActivity();
+
+	case ScreenGenerationRole:
+		return computerControl->screenGeneration();
+
 	default:
 		break;
 	}
@@ -117,6 +164,10 @@ void ComputerControlListModel::updateComputerScreenSize()
 	{
 		controlInterface->setScaledScreenSize( size );
 	}
+
+	// thumbnails of other sizes are dropped when loaded
+	m_cachedThumbnails.clear();
+	loadThumbnails( m_computerControlInterfaces );
 }
 
 
@@ -142,6 +193,9 @@ void ComputerControlListModel::reload()
 
 	m_computerControlInterfaces.clear();
 	m_computerControlInterfaces.reserve( computerList.size() );
+	m_screenGenerations.clear();
+	m_activeScreens.clear();
+	m_cachedThumbnails.clear();
 
 	int row = 0;
 
@@ -154,6 +208,8 @@ void ComputerControlListModel::reload()
 	}
 
 	endResetModel();
+
+	loadThumbnails( m_computerControlInterfaces );
 }
 
 
@@ -166,15 +222,32 @@ void ComputerControlListModel::update()
 
 	for( auto it = m_computerControlInterfaces.begin(); it != m_computerControlInterfaces.end(); ) // clazy:exclude=detaching-member
 	{
-		if( newComputerList.contains( (*it)->computer() ) == false )
+		const auto newIndex = newComputerList.indexOf( (*it)->computer() );
+		if( newIndex < 0 )
 		{
 			beginRemoveRows( QModelIndex(), row, row );
 			emit rowAboutToBeRemoved( index( row ) );
+			m_screenGenerations.remove( it->data() );
+			m_activeScreens.remove( it->data() );
+			m_cachedThumbnails.remove( (*it)->computer().networkObjectUid() );
 			it = m_computerControlInterfaces.erase( it );
 			endRemoveRows();
 		}
 		else
 		{
+			const auto& computer = newComputerList[newIndex];
+			const auto& currentComputer = (*it)->computer();
+
+			// apply changes in directory, reconnects immediately if the host address changed
+			if( computer.name() != currentComputer.name() ||
+					computer.hostAddress() != currentComputer.hostAddress() ||
+					computer.macAddress() != currentComputer.macAddress() ||
+					computer.room() != currentComputer.room() )
+			{
+				(*it)->setComputer( computer );
+				emit dataChanged( index( row ), index( row ) );
+			}
+
 			++it;
 			++row;
 		}
@@ -182,6 +255,8 @@ void ComputerControlListModel::update()
 
 	row = 0;
 
+	ComputerControlInterfaceList insertedControlInterfaces;
+
 	for( const auto& computer : newComputerList )
 	{
 		if( row < m_computerControlInterfaces.count() && m_computerControlInterfaces[row]->computer() != computer )
@@ -190,6 +265,7 @@ void ComputerControlListModel::update()
 			const auto controlInterface = ComputerControlInterface::Pointer::create( computer );
 			m_computerControlInterfaces.insert( row, controlInterface );
 			startComputerControlInterface( controlInterface, index( row ) );
+			insertedControlInterfaces.append( controlInterface );
 			endInsertRows();
 		}
 		else if( row >= m_computerControlInterfaces.count() )
@@ -198,31 +274,124 @@ void ComputerControlListModel::update()
 			const auto controlInterface = ComputerControlInterface::Pointer::create( computer );
 			m_computerControlInterfaces.append( controlInterface );
 			startComputerControlInterface( controlInterface, index( row ) ); // clazy:exclude=detaching-member
+			insertedControlInterfaces.append( controlInterface );
 			endInsertRows();
 		}
 
 		++row;
 	}
+
+	loadThumbnails( insertedControlInterfaces );
 }
 
 
 
 void ComputerControlListModel::updateComputerScreens()
 {
-	int computerIndex = 0;
+	const QVector<int> roles( { Qt::DisplayRole, Qt::DecorationRole, Qt::ToolTipRole, ScreenActivityRole } );
 
-	for( auto& controlInterface : m_computerControlInterfaces )
+	// emit one signal per range of contiguous changed rows
+	int firstChangedRow = -1;
+
+	for( int row = 0, count = m_computerControlInterfaces.count(); row <= count; ++row )
 	{
-		if( controlInterface->hasScreenUpdates() )
+		bool changed = false;
+
+		if( row < count )
 		{
-			controlInterface->clearScreenUpdateFlag();
+			const auto controlInterface = m_computerControlInterfaces[row].data();
+			const auto generation = controlInterface->screenGeneration();
+
+			auto it = m_screenGenerations.find( controlInterface );
+			if( it == m_screenGenerations.end() || it.value() != generation )
+			{
+				m_screenGenerations[controlInterface] = generation;
+				changed = true;
+
+				// cached thumbnail is not needed anymore once the live screen is available
+				if( m_cachedThumbnails.isEmpty() == false &&
+						controlInterface->state() == ComputerControlInterface::Connected &&
+						controlInterface->scaledScreen().isNull() == false )
+				{
+					m_cachedThumbnails.remove( controlInterface->computer().networkObjectUid() );
+				}
+			}
 
-			emit dataChanged( index( computerIndex, 0 ),
-							  index( computerIndex, 0 ),
-							  QVector<int>( { Qt::DisplayRole, Qt::DecorationRole, Qt::ToolTipRole } ) );
+			// activity decays without screen updates so check separately whether to highlight the screen
+			const auto active = controlInterface->screenActivity() >= FramebufferActivityDetector::HighActivity;
+			if( active != m_activeScreens.contains( controlInterface ) )
+			{
+				if( active )
+				{
+					m_activeScreens.insert( controlInterface );
+				}
+				else
+				{
+					m_activeScreens.remove( controlInterface );
+				}
+				changed = true;
+			}
+		}
+
+		if( changed && firstChangedRow < 0 )
+		{
+			firstChangedRow = row;
+		}
+		else if( changed == false && firstChangedRow >= 0 )
+		{
+			emit dataChanged( index( firstChangedRow, 0 ), index( row - 1, 0 ), roles );
+			firstChangedRow = -1;
 		}
+	}
+}
+
+
+
+void ComputerControlListModel::dumpConnectionStatistics()
+{
+	QJsonArray computers;
+
+	for( const auto& controlInterface : qAsConst(m_computerControlInterfaces) )
+	{
+		computers.append( QJsonObject( {
+										   { QStringLiteral("name"), controlInterface->computer().name() },
+										   { QStringLiteral("hostAddress"), controlInterface->computer().hostAddress() },
+										   { QStringLiteral("statistics"), controlInterface->connectionStatistics() }
+									   } ) );
+	}
+
+	const auto logPath = VeyonCore::filesystem().expandPath( VeyonCore::config().logFileDirectory() );
+
+	QFile file( logPath + QDir::separator() + QStringLiteral("VeyonMaster-ConnectionStatistics.json") );
+	if( file.open( QFile::WriteOnly | QFile::Truncate ) == false )
+	{
+		qWarning() << "ComputerControlListModel::dumpConnectionStatistics(): could not open" << file.fileName();
+		return;
+	}
+
+	const QJsonObject statistics( {
+									  { QStringLiteral("computers"), computers },
+									  { QStringLiteral("framebufferPool"), FramebufferPool::instance().statisticsToJson() }
+								  } );
+
+	file.write( QJsonDocument( statistics ).toJson() );
+}
+
+
 
-		++computerIndex;
+void ComputerControlListModel::storeThumbnails()
+{
+	// do not queue up writes if the disk is slow
+	if( m_thumbnailStoreFuture.isRunning() )
+	{
+		return;
+	}
+
+	const auto thumbnails = changedThumbnails();
+	if( thumbnails.isEmpty() == false )
+	{
+		auto cache = &m_thumbnailCache;
+		m_thumbnailStoreFuture = QtConcurrent::run( [=]() { cache->store( thumbnails ); } );
 	}
 }
 
@@ -287,6 +456,16 @@ QImage ComputerControlListModel::computerDecorationRole( ComputerControlInterfac
 	case ComputerControlInterface::Connected:
 		image = controlInterface->scaledScreen();
 		if( image.isNull() == false )
+		{
+			if( m_connectionStatisticsEnabled )
+			{
+				return drawConnectionStatistics( image, controlInterface );
+			}
+			return image;
+		}
+
+		image = m_cachedThumbnails.value( controlInterface->computer().networkObjectUid() );
+		if( image.isNull() == false )
 		{
 			return image;
 		}
@@ -300,6 +479,12 @@ QImage ComputerControlListModel::computerDecorationRole( ComputerControlInterfac
 		break;
 
 	default:
+		image = m_cachedThumbnails.value( controlInterface->computer().networkObjectUid() );
+		if( image.isNull() == false )
+		{
+			return image;
+		}
+
 		image = m_iconDefault;
 		break;
 	}
@@ -309,6 +494,147 @@ QImage ComputerControlListModel::computerDecorationRole( ComputerControlInterfac
 
 
 
+void ComputerControlListModel::loadThumbnails( const ComputerControlInterfaceList& controlInterfaces )
+{
+	if( m_thumbnailCacheEnabled == false )
+	{
+		return;
+	}
+
+	QList<NetworkObject::Uid> uids;
+	uids.reserve( controlInterfaces.size() );
+	for( const auto& controlInterface : controlInterfaces )
+	{
+		uids.append( controlInterface->computer().networkObjectUid() );
+	}
+
+	if( uids.isEmpty() )
+	{
+		return;
+	}
+
+	// decode and scale in background so the view never waits for the disk
+	const auto cache = m_thumbnailCache;
+	const auto size = computerScreenSize();
+
+	auto watcher = new QFutureWatcher<ThumbnailCache::ThumbnailMap>( this );
+	connect( watcher, &QFutureWatcherBase::finished, this, [=]() {
+		updateCachedThumbnails( watcher->result(), size );
+		watcher->deleteLater();
+	} );
+
+	watcher->setFuture( QtConcurrent::run( [=]() {
+		ThumbnailCache::ThumbnailMap thumbnails;
+		for( const auto& uid : uids )
+		{
+			const auto image = cache.load( uid );
+			if( image.isNull() == false )
+			{
+				thumbnails[uid] = prepareThumbnail( image, size );
+			}
+		}
+		return thumbnails;
+	} ) );
+}
+
+
+
+void ComputerControlListModel::updateCachedThumbnails( const ThumbnailCache::ThumbnailMap& thumbnails, QSize size )
+{
+	// screen size changed while loading
+	if( thumbnails.isEmpty() || size != computerScreenSize() )
+	{
+		return;
+	}
+
+	const QVector<int> roles( { Qt::DecorationRole } );
+
+	for( int row = 0; row < m_computerControlInterfaces.count(); ++row )
+	{
+		const auto uid = m_computerControlInterfaces[row]->computer().networkObjectUid();
+		const auto it = thumbnails.find( uid );
+		if( it != thumbnails.end() )
+		{
+			m_cachedThumbnails[uid] = it.value();
+			emit dataChanged( index( row ), index( row ), roles );
+		}
+	}
+}
+
+
+
+QImage ComputerControlListModel::prepareThumbnail( const QImage& thumbnail, QSize size )
+{
+	auto image = thumbnail;
+	if( image.size() != size )
+	{
+		image = image.scaled( size, Qt::KeepAspectRatio, Qt::SmoothTransformation );
+	}
+
+	// dim image to indicate it does not show the current screen content
+	image = image.convertToFormat( QImage::Format_ARGB32_Premultiplied );
+	QPainter painter( &image );
+	painter.fillRect( image.rect(), QColor( 128, 128, 128, 160 ) );
+	painter.end();
+
+	return image;
+}
+
+
+
+ThumbnailCache::ThumbnailMap ComputerControlListModel::changedThumbnails()
+{
+	ThumbnailCache::ThumbnailMap thumbnails;
+
+	for( const auto& controlInterface : qAsConst(m_computerControlInterfaces) )
+	{
+		if( controlInterface->state() != ComputerControlInterface::Connected )
+		{
+			continue;
+		}
+
+		const auto uid = controlInterface->computer().networkObjectUid();
+		const auto generation = controlInterface->screenGeneration();
+
+		auto it = m_storedScreenGenerations.find( uid );
+		if( it != m_storedScreenGenerations.end() && it.value() == generation )
+		{
+			continue;
+		}
+
+		const auto image = controlInterface->scaledScreen();
+		if( image.isNull() == false )
+		{
+			thumbnails[uid] = image;
+			m_storedScreenGenerations[uid] = generation;
+		}
+	}
+
+	return thumbnails;
+}
+
+
+
+QImage ComputerControlListModel::drawConnectionStatistics( const QImage& image, ComputerControlInterface::Pointer controlInterface )
+{
+	auto overlay = image.convertToFormat( QImage::Format_ARGB32_Premultiplied );
+
+	QPainter painter( &overlay );
+
+	auto font = painter.font();
+	font.setPixelSize( qMax( 8, overlay.height() / 16 ) );
+	painter.setFont( font );
+
+	const QRect textRect( 0, overlay.height() - painter.fontMetrics().height(), overlay.width(), painter.fontMetrics().height() );
+	painter.fillRect( textRect, QColor( 0, 0, 0, 160 ) );
+	painter.setPen( Qt::white );
+	painter.drawText( textRect, Qt::AlignCenter, controlInterface->connectionStatisticsSummary() );
+
+	return overlay;
+}
+
+
+
 QString ComputerControlListModel::computerToolTipRole( ComputerControlInterface::Pointer controlInterface ) const
 {
 	const QString state( computerStateDescription( controlInterface ) );
@@ -322,7 +648,9 @@ QString ComputerControlListModel::computerToolTipRole( ComputerControlInterface:
 		return QStringLiteral( "<b>%1</b><br>%2<br>%3<br>%4" ).arg( state, room, host, features );
 	}
 
-	return QStringLiteral( "<b>%1</b><br>%2<br>%3<br>%4<br>%5" ).arg( state, room, host, features, user);
+	const QString activity( tr( "Screen activity: %1%" ).arg( controlInterface->screenActivity() / 10.0, 0, 'f', 1 ) );
+
+	return QStringLiteral( "<b>%1</b><br>%2<br>%3<br>%4<br>%5<br>%6" ).arg( state, room, host, features, user, activity );
 }
 
 
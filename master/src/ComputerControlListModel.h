@@ -26,9 +26,13 @@
 #define COMPUTER_CONTROL_LIST_MODEL_H
 
 #include <QAbstractListModel>
+#include <QFuture>
+#include <QHash>
 #include <QImage>
+#include <QSet>
 
 #include "ComputerControlInterface.h"
+#include "ThumbnailCache.h"
 
 class VeyonMaster;
 
@@ -37,7 +41,14 @@ class ComputerControlListModel : public QAbstractListModel
 	Q_OBJECT
 public:
 	enum {
-		UidRole = Qt::UserRole
+		UidRole = Qt::UserRole,
+		ScreenActivityRole,
+		ScreenGenerationRole
+	};
+
+	enum {
+		ConnectionStatisticsDumpInterval = 10000,
+		ThumbnailStoreInterval = 30000
 	};
 
 	enum DisplayRoleContent {
@@ -48,6 +59,7 @@ public:
 	};
 
 	ComputerControlListModel( VeyonMaster* masterCore, QObject* parent = nullptr );
+	~ComputerControlListModel() override;
 
 	int rowCount( const QModelIndex& parent = QModelIndex() ) const override;
 
@@ -80,6 +92,10 @@ private slots:
 
 	void updateComputerScreens();
 
+	void dumpConnectionStatistics();
+
+	void storeThumbnails();
+
 private:
 	void startComputerControlInterface( ComputerControlInterface::Pointer controlInterface, QModelIndex index );
 
@@ -88,6 +104,11 @@ private:
 	void loadIcons();
 	QImage prepareIcon( const QImage& icon );
 	QImage computerDecorationRole( ComputerControlInterface::Pointer controlInterface ) const;
+	void loadThumbnails( const ComputerControlInterfaceList& controlInterfaces );
+	void updateCachedThumbnails( const ThumbnailCache::ThumbnailMap& thumbnails, QSize size );
+	static QImage prepareThumbnail( const QImage& thumbnail, QSize size );
+	ThumbnailCache::ThumbnailMap changedThumbnails();
+	static QImage drawConnectionStatistics( const QImage& image, ComputerControlInterface::Pointer controlInterface );
 	QString computerToolTipRole( ComputerControlInterface::Pointer controlInterface ) const;
 	QString computerDisplayRole( ComputerControlInterface::Pointer controlInterface ) const;
 	static QString computerStateDescription( ComputerControlInterface::Pointer controlInterface );
@@ -97,12 +118,21 @@ private:
 	VeyonMaster* m_master;
 
 	DisplayRoleContent m_displayRoleContent;
+	bool m_connectionStatisticsEnabled;
+	bool m_thumbnailCacheEnabled;
 
 	QImage m_iconDefault;
 	QImage m_iconConnectionProblem;
 	QImage m_iconDemoMode;
 
 	ComputerControlInterfaceList m_computerControlInterfaces;
+	QHash<const ComputerControlInterface *, quint32> m_screenGenerations;
+	QSet<const ComputerControlInterface *> m_activeScreens;
+
+	ThumbnailCache m_thumbnailCache;
+	ThumbnailCache::ThumbnailMap m_cachedThumbnails;
+	QHash<NetworkObject::Uid, quint32> m_storedScreenGenerations;
+	QFuture<void> m_thumbnailStoreFuture;
 
 };
 
@@ -27,6 +27,9 @@
 #include <QHostAddress>
 #include <QHostInfo>
 #include <QMessageBox>
+#include <QNetworkInterface>
+#include <QTimer>
+#include <QtConcurrent>
 
 #include "ComputerManager.h"
 #include "VeyonConfiguration.h"
@@ -49,7 +52,11 @@ ComputerManager::ComputerManager( UserConfig& config, QObject* parent ) :
 	m_computerTreeModel( new CheckableItemProxyModel( NetworkObjectModel::UidRole, this ) ),
 	m_networkObjectFilterProxyModel( new NetworkObjectFilterProxyModel( this ) ),
 	m_localHostNames( QHostInfo::localHostName().toLower() ),
-	m_localHostAddresses( QHostInfo::fromName( QHostInfo::localHostName() ).addresses() )
+	m_localHostAddresses( QNetworkInterface::allAddresses() ),
+	m_startupStage( LoadDirectoryStage ),
+	m_startupTimer(),
+	m_startupStageTimer(),
+	m_directoryLoader()
 {
 	if( m_networkObjectDirectory == nullptr )
 	{
@@ -70,15 +77,59 @@ ComputerManager::ComputerManager( UserConfig& config, QObject* parent ) :
 	}
 
 	initNetworkObjectLayer();
-	initRooms();
-	initComputerTreeModel();
+
+	connect( &m_directoryLoader, &QFutureWatcherBase::finished, this, &ComputerManager::finishDirectoryLoading );
 }
 
 
 
 ComputerManager::~ComputerManager()
 {
-	m_config.setCheckedNetworkObjects( m_computerTreeModel->saveStates() );
+	m_directoryLoader.waitForFinished();
+
+	// do not overwrite stored selection if it has not been restored yet
+	if( m_startupStage > RestoreSelectionStage )
+	{
+		m_config.setCheckedNetworkObjects( m_computerTreeModel->saveStates() );
+	}
+}
+
+
+
+void ComputerManager::startup()
+{
+	if( m_startupTimer.isValid() )
+	{
+		return;
+	}
+
+	m_startupTimer.start();
+
+	emit startupProgress( m_startupStage );
+
+	QTimer::singleShot( 0, this, &ComputerManager::runStartupStage );
+}
+
+
+
+QString ComputerManager::startupStageDescription( int stage )
+{
+	switch( stage )
+	{
+	case LoadDirectoryStage:
+		return tr( "Loading computer directory ..." );
+
+	case DetectRoomsStage:
+		return tr( "Detecting current room ..." );
+
+	case RestoreSelectionStage:
+		return tr( "Restoring computer selection ..." );
+
+	default:
+		break;
+	}
+
+	return QString();
 }
 
 
@@ -156,19 +207,99 @@ void ComputerManager::updateUser( ComputerControlInterface::Pointer controlInter
 
 
 
-void ComputerManager::initRooms()
+void ComputerManager::runStartupStage()
+{
+	m_startupStageTimer.start();
+
+	switch( m_startupStage )
+	{
+	case LoadDirectoryStage:
+		// continues in finishDirectoryLoading() once the worker thread is done
+		loadDirectory();
+		return;
+
+	case DetectRoomsStage:
+		initRooms();
+		break;
+
+	case RestoreSelectionStage:
+		restoreSelection();
+		break;
+
+	default:
+		return;
+	}
+
+	finishStartupStage();
+}
+
+
+
+void ComputerManager::finishDirectoryLoading()
+{
+	m_networkObjectDirectory->setObjects( m_directoryLoader.result().objects );
+	m_networkObjectDirectory->setUpdateInterval( VeyonCore::config().networkObjectDirectoryUpdateInterval() );
+
+	finishStartupStage();
+}
+
+
+
+void ComputerManager::finishStartupStage()
+{
+	qDebug() << "ComputerManager::finishStartupStage(): stage" << startupStageDescription( m_startupStage )
+			 << "took" << m_startupStageTimer.elapsed() << "ms";
+
+	++m_startupStage;
+
+	if( m_startupStage < StartupStageCount )
+	{
+		emit startupProgress( m_startupStage );
+
+		// let the event loop update the UI before running the next stage
+		QTimer::singleShot( 0, this, &ComputerManager::runStartupStage );
+	}
+	else
+	{
+		qDebug() << "ComputerManager::finishStartupStage(): startup finished after" << m_startupTimer.elapsed() << "ms";
+
+		emit startupFinished();
+	}
+}
+
+
+
+void ComputerManager::loadDirectory()
 {
 	for( const auto& hostName : qAsConst( m_localHostNames ) )
 	{
-		qDebug() << "ComputerManager::initRooms(): initializing rooms for host name" << hostName;
+		qDebug() << "ComputerManager::loadDirectory(): detecting rooms for host name" << hostName;
 	}
 
 	for( const auto& address : qAsConst( m_localHostAddresses ) )
 	{
-		qDebug() << "ComputerManager::initRooms(): initializing rooms for host address" << address.toString();
+		qDebug() << "ComputerManager::loadDirectory(): detecting rooms for host address" << address.toString();
 	}
 
-	m_currentRooms.append( findRoomOfComputer( m_localHostNames, m_localHostAddresses, QModelIndex() ) );
+	// querying the directory (e.g. an LDAP server) and searching it may take a
+	// while so do both in a worker thread and apply the results afterwards
+	const auto directory = m_networkObjectDirectory;
+	const auto hostNames = m_localHostNames;
+	const auto hostAddresses = m_localHostAddresses;
+
+	m_directoryLoader.setFuture( QtConcurrent::run( [=]() {
+		DirectorySnapshot snapshot;
+		snapshot.objects = directory->fetchObjects();
+		snapshot.localRoom = findRoomOfComputer( hostNames, hostAddresses, snapshot.objects );
+		return snapshot;
+	} ) );
+}
+
+
+
+void ComputerManager::initRooms()
+{
+	m_currentRooms.append( m_directoryLoader.result().localRoom );
 
 	qDebug() << "ComputerManager::initRooms(): found local rooms" << m_currentRooms;
 
@@ -193,8 +324,6 @@ void ComputerManager::initRooms()
 
 void ComputerManager::initNetworkObjectLayer()
 {
-	m_networkObjectDirectory->update();
-	m_networkObjectDirectory->setUpdateInterval( VeyonCore::config().networkObjectDirectoryUpdateInterval() );
 	m_networkObjectOverlayDataModel->setSourceModel( m_networkObjectModel );
 	m_networkObjectFilterProxyModel->setSourceModel( m_networkObjectOverlayDataModel );
 	m_computerTreeModel->setSourceModel( m_networkObjectFilterProxyModel );
@@ -224,7 +353,7 @@ void ComputerManager::initNetworkObjectLayer()
 
 
 
-void ComputerManager::initComputerTreeModel()
+void ComputerManager::restoreSelection()
 {
 	QJsonArray checkedNetworkObjects;
 	if( VeyonCore::config().autoSwitchToCurrentRoom() )
@@ -245,6 +374,7 @@ void ComputerManager::initComputerTreeModel()
 
 	m_computerTreeModel->loadStates( checkedNetworkObjects );
 
+	// track selection changes not before the directory has been loaded completely
 	connect( computerTreeModel(), &QAbstractItemModel::modelReset,
 			 this, &ComputerManager::computerSelectionReset );
 	connect( computerTreeModel(), &QAbstractItemModel::layoutChanged,
@@ -256,6 +386,8 @@ void ComputerManager::initComputerTreeModel()
 			 this, &ComputerManager::computerSelectionChanged );
 	connect( computerTreeModel(), &QAbstractItemModel::rowsRemoved,
 			 this, &ComputerManager::computerSelectionChanged );
+
+	emit computerSelectionReset();
 }
 
 
@@ -270,35 +402,25 @@ void ComputerManager::updateRoomFilterList()
 
 
 
-QString ComputerManager::findRoomOfComputer( const QStringList& hostNames, const QList<QHostAddress>& hostAddresses, const QModelIndex& parent )
+QString ComputerManager::findRoomOfComputer( const QStringList& hostNames, const QList<QHostAddress>& hostAddresses,
+											 const NetworkObjectDirectory::ObjectMap& objects )
 {
-	QAbstractItemModel* model = networkObjectModel();
-
-	int rows = model->rowCount( parent );
-
-	for( int i = 0; i < rows; ++i )
+	for( auto it = objects.constBegin(), end = objects.constEnd(); it != end; ++it )
 	{
-		QModelIndex entryIndex = model->index( i, 0, parent );
-
-		auto objectType = static_cast<NetworkObject::Type>( model->data( entryIndex, NetworkObjectModel::TypeRole ).toInt() );
-
-		if( objectType == NetworkObject::Group )
+		for( const auto& object : it.value() )
 		{
-			QString room = findRoomOfComputer( hostNames, hostAddresses, entryIndex );
-			if( room.isEmpty() == false )
+			if( object.type() != NetworkObject::Host )
 			{
-				return room;
+				continue;
 			}
-		}
-		else if( objectType == NetworkObject::Host )
-		{
-			QString currentHost = model->data( entryIndex, NetworkObjectModel::HostAddressRole ).toString().toLower();
+
+			const auto currentHost = object.hostAddress().toLower();
 			QHostAddress currentHostAddress;
 
 			if( hostNames.contains( currentHost ) ||
 					( currentHostAddress.setAddress( currentHost ) && hostAddresses.contains( currentHostAddress ) ) )
 			{
-				return model->data( parent, NetworkObjectModel::NameRole ).toString();
+				return it.key().name();
 			}
 		}
 	}
@@ -25,11 +25,14 @@
 #ifndef COMPUTER_MANAGER_H
 #define COMPUTER_MANAGER_H
 
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+
 #include "CheckableItemProxyModel.h"
 #include "ComputerControlInterface.h"
+#include "NetworkObjectDirectory.h"
 
 class QHostAddress;
-class NetworkObjectDirectory;
 class NetworkObjectFilterProxyModel;
 class NetworkObjectOverlayDataModel;
 class UserConfig;
@@ -38,9 +41,21 @@ class ComputerManager : public QObject
 {
 	Q_OBJECT
 public:
+	enum StartupStage {
+		LoadDirectoryStage,
+		DetectRoomsStage,
+		RestoreSelectionStage,
+		StartupStageCount
+	};
+
 	ComputerManager( UserConfig& config, QObject* parent );
 	~ComputerManager() override;
 
+	/** \brief Runs the startup stages one by one from the event loop (once only) so the main window can be shown before */
+	void startup();
+
+	static QString startupStageDescription( int stage );
+
 	QAbstractItemModel* networkObjectModel()
 	{
 		return m_networkObjectModel;
@@ -63,14 +78,29 @@ public:
 signals:
 	void computerSelectionReset();
 	void computerSelectionChanged();
+	void startupProgress( int stage );
+	void startupFinished();
+
+private slots:
+	void runStartupStage();
+	void finishDirectoryLoading();
 
 private:
+	struct DirectorySnapshot {
+		NetworkObjectDirectory::ObjectMap objects;
+		QString localRoom;
+	};
+
+	void finishStartupStage();
+
+	void loadDirectory();
 	void initRooms();
 	void initNetworkObjectLayer();
-	void initComputerTreeModel();
+	void restoreSelection();
 	void updateRoomFilterList();
 
-	QString findRoomOfComputer( const QStringList& hostNames, const QList<QHostAddress>& hostAddresses, const QModelIndex& parent );
+	static QString findRoomOfComputer( const QStringList& hostNames, const QList<QHostAddress>& hostAddresses,
+									   const NetworkObjectDirectory::ObjectMap& objects );
 
 	ComputerList getComputersInRoom( const QString& roomName, const QModelIndex& parent = QModelIndex() );
 
@@ -90,6 +120,11 @@ private:
 	QStringList m_localHostNames;
 	QList<QHostAddress> m_localHostAddresses;
 
+	int m_startupStage;
+	QElapsedTimer m_startupTimer;
+	QElapsedTimer m_startupStageTimer;
+	QFutureWatcher<DirectorySnapshot> m_directoryLoader;
+
 };
 
 #endif // COMPUTER_MANAGER_H
@@ -0,0 +1,145 @@
+/*
+ * ComputerMonitoringItemDelegate.cpp - implementation of ComputerMonitoringItemDelegate
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QApplication>
+#include <QPainter>
+
+#include "ComputerMonitoringItemDelegate.h"
+#include "FramebufferActivityDetector.h"
+
+
+ComputerMonitoringItemDelegate::ComputerMonitoringItemDelegate( int uidRole, int screenGenerationRole, int screenActivityRole,
+																QObject* parent ) :
+	QStyledItemDelegate( parent ),
+	m_uidRole( uidRole ),
+	m_screenGenerationRole( screenGenerationRole ),
+	m_screenActivityRole( screenActivityRole ),
+	m_cache()
+{
+}
+
+
+
+void ComputerMonitoringItemDelegate::paint( QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index ) const
+{
+	const auto& item = cachedItem( option, index );
+
+	const auto widget = option.widget;
+	const auto style = widget ? widget->style() : QApplication::style();
+
+	// selection and hover background
+	style->drawPrimitive( QStyle::PE_PanelItemViewItem, &option, painter, widget );
+
+	const auto screenSize = item.screen.size() / item.screen.devicePixelRatio();
+	const QRect screenRect( option.rect.left() + ( option.rect.width() - screenSize.width() ) / 2,
+							option.rect.top() + Margin + ( item.size.height() - screenSize.height() ) / 2,
+							screenSize.width(), screenSize.height() );
+	painter->drawPixmap( screenRect.topLeft(), item.screen );
+
+	if( index.data( m_screenActivityRole ).toInt() >= FramebufferActivityDetector::HighActivity )
+	{
+		// frame lies within the margin around the screen
+		painter->setPen( QPen( QColor( 255, 128, 0 ), Margin ) );
+		painter->setBrush( Qt::NoBrush );
+		painter->drawRect( QRectF( screenRect ).adjusted( -Margin / 2.0, -Margin / 2.0, Margin / 2.0, Margin / 2.0 ) );
+	}
+
+	const auto textSize = item.text.size();
+	painter->setFont( option.font );
+	painter->setPen( option.palette.color( option.state & QStyle::State_Enabled ? QPalette::Normal : QPalette::Disabled,
+										   option.state & QStyle::State_Selected ? QPalette::HighlightedText : QPalette::Text ) );
+	painter->drawStaticText( QPointF( option.rect.left() + ( option.rect.width() - textSize.width() ) / 2,
+									  option.rect.top() + item.size.height() + 2 * Margin ),
+							 item.text );
+
+	if( option.state & QStyle::State_HasFocus )
+	{
+		QStyleOptionFocusRect focusOption;
+		focusOption.QStyleOption::operator=( option );
+		focusOption.backgroundColor = option.palette.color( QPalette::Base );
+		style->drawPrimitive( QStyle::PE_FrameFocusRect, &focusOption, painter, widget );
+	}
+}
+
+
+
+QSize ComputerMonitoringItemDelegate::sizeHint( const QStyleOptionViewItem& option, const QModelIndex& index ) const
+{
+	Q_UNUSED(index)
+
+	return QSize( option.decorationSize.width() + 2 * Margin,
+				  option.decorationSize.height() + option.fontMetrics.height() + 3 * Margin );
+}
+
+
+
+void ComputerMonitoringItemDelegate::removeCachedItem( const QUuid& uid )
+{
+	m_cache.remove( uid );
+}
+
+
+
+void ComputerMonitoringItemDelegate::clearCache()
+{
+	m_cache.clear();
+}
+
+
+
+const ComputerMonitoringItemDelegate::CachedItem& ComputerMonitoringItemDelegate::cachedItem( const QStyleOptionViewItem& option,
+																							 const QModelIndex& index ) const
+{
+	const auto uid = index.data( m_uidRole ).toUuid();
+	const auto screenGeneration = index.data( m_screenGenerationRole ).toUInt();
+
+	auto it = m_cache.find( uid );
+	const auto isNewItem = it == m_cache.end();
+	if( isNewItem )
+	{
+		it = m_cache.insert( uid, CachedItem() );
+	}
+
+	const auto sizeChanged = it->size != option.decorationSize;
+
+	if( isNewItem || sizeChanged || it->screenGeneration != screenGeneration )
+	{
+		it->screen = QPixmap::fromImage( index.data( Qt::DecorationRole ).value<QImage>() );
+	}
+
+	// display text is expensive to query and only changes along with other data of the item
+	if( isNewItem || sizeChanged || it->font != option.font )
+	{
+		it->font = option.font;
+		it->text.setText( option.fontMetrics.elidedText( index.data( Qt::DisplayRole ).toString(),
+														 Qt::ElideRight, option.decorationSize.width() ) );
+		it->text.setTextFormat( Qt::PlainText );
+		it->text.prepare( QTransform(), option.font );
+	}
+
+	it->screenGeneration = screenGeneration;
+	it->size = option.decorationSize;
+
+	return *it;
+}
@@ -0,0 +1,85 @@
+/*
+ * ComputerMonitoringItemDelegate.h - header file for ComputerMonitoringItemDelegate
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef COMPUTER_MONITORING_ITEM_DELEGATE_H
+#define COMPUTER_MONITORING_ITEM_DELEGATE_H
+
+#include <QFont>
+#include <QHash>
+#include <QPixmap>
+#include <QStaticText>
+#include <QStyledItemDelegate>
+#include <QUuid>
+
+/*!
+ * \brief Paints computer screens in the monitoring view from a per-computer cache
+ *
+ * The screen pixmap and the elided, prepared name text of each computer are cached. The pixmap is
+ * only rebuilt if the screen generation reported by the model or the item size changed, the text
+ * only if the font or the item size changed. Items whose data changed otherwise (e.g. the display
+ * text) have to be removed by the view via removeCachedItem(). Repaints without changed content
+ * (e.g. while scrolling or selecting) therefore neither query the display text, convert images
+ * nor lay out text.
+ *
+ * Screens changing a lot, e.g. while videos are played, are framed in orange.
+ */
+class ComputerMonitoringItemDelegate : public QStyledItemDelegate
+{
+	Q_OBJECT
+public:
+	enum {
+		Margin = 2
+	};
+
+	ComputerMonitoringItemDelegate( int uidRole, int screenGenerationRole, int screenActivityRole, QObject* parent = nullptr );
+
+	void paint( QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index ) const override;
+	QSize sizeHint( const QStyleOptionViewItem& option, const QModelIndex& index ) const override;
+
+	void removeCachedItem( const QUuid& uid );
+
+public slots:
+	void clearCache();
+
+private:
+	struct CachedItem
+	{
+		quint32 screenGeneration;
+		QSize size;
+		QPixmap screen;
+		QFont font;
+		QStaticText text;
+	};
+
+	const CachedItem& cachedItem( const QStyleOptionViewItem& option, const QModelIndex& index ) const;
+
+	const int m_uidRole;
+	const int m_screenGenerationRole;
+	const int m_screenActivityRole;
+
+	mutable QHash<QUuid, CachedItem> m_cache;
+
+};
+
+#endif // COMPUTER_MONITORING_ITEM_DELEGATE_H
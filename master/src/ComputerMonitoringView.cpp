@@ -24,6 +24,7 @@
 
 #include <QMenu>
 #include <QScrollBar>
+#include <QSet>
 #include <QShowEvent>
 #include <QTimer>
 
@@ -42,11 +43,14 @@ ComputerMonitoringView::ComputerMonitoringView( QWidget *parent ) :
 	ui(new Ui::ComputerMonitoringView),
 	m_master( nullptr ),
 	m_featureMenu( new QMenu( this ) ),
-	m_sortFilterProxyModel( this )
+	m_sortFilterProxyModel( this ),
+	m_itemDelegate( ComputerControlListModel::UidRole, ComputerControlListModel::ScreenGenerationRole,
+					ComputerControlListModel::ScreenActivityRole, this )
 {
 	ui->setupUi( this );
 
 	ui->listView->setUidRole( ComputerControlListModel::UidRole );
+	ui->listView->setItemDelegate( &m_itemDelegate );
 
 	m_sortFilterProxyModel.setFilterCaseSensitivity( Qt::CaseInsensitive );
 
@@ -55,6 +59,29 @@ ComputerMonitoringView::ComputerMonitoringView( QWidget *parent ) :
 
 	connect( ui->listView, &QListView::customContextMenuRequested,
 			 this, &ComputerMonitoringView::showContextMenu );
+
+	connect( ui->listView, &FlexibleListView::visibleIndexesChanged,
+			 this, &ComputerMonitoringView::updateVisibleComputers );
+
+	// drop cached pixmaps of computers no longer shown
+	connect( &m_sortFilterProxyModel, &QSortFilterProxyModel::modelReset,
+			 &m_itemDelegate, &ComputerMonitoringItemDelegate::clearCache );
+	connect( &m_sortFilterProxyModel, &QSortFilterProxyModel::rowsAboutToBeRemoved,
+			 this, [this]( const QModelIndex& parent, int first, int last ) {
+		for( int row = first; row <= last; ++row )
+		{
+			m_itemDelegate.removeCachedItem( m_sortFilterProxyModel.index( row, 0, parent ).data( ComputerControlListModel::UidRole ).toUuid() );
+		}
+	} );
+
+	// rebuild items changed without a new screen, e.g. when cached thumbnails have been loaded
+	connect( &m_sortFilterProxyModel, &QSortFilterProxyModel::dataChanged,
+			 this, [this]( const QModelIndex& topLeft, const QModelIndex& bottomRight ) {
+		for( int row = topLeft.row(); row <= bottomRight.row(); ++row )
+		{
+			m_itemDelegate.removeCachedItem( m_sortFilterProxyModel.index( row, 0, topLeft.parent() ).data( ComputerControlListModel::UidRole ).toUuid() );
+		}
+	} );
 }
 
 
@@ -93,6 +120,9 @@ void ComputerMonitoringView::setVeyonMaster( VeyonMaster& masterCore )
 	// attach proxy model to view
 	ui->listView->setModel( &m_sortFilterProxyModel );
 
+	connect( ui->listView->selectionModel(), &QItemSelectionModel::currentChanged,
+			 this, &ComputerMonitoringView::updateFocusedComputer );
+
 	// load custom positions
 	ui->listView->loadPositions( m_master->userConfig().computerPositions() );
 	ui->listView->setFlexible( m_master->userConfig().useCustomComputerPositions() );
@@ -126,6 +156,62 @@ void ComputerMonitoringView::setSearchFilter( const QString& searchFilter )
 
 
 
+void ComputerMonitoringView::updateVisibleComputers()
+{
+	if( m_master == nullptr )
+	{
+		return;
+	}
+
+	const auto& computerControlListModel = m_master->computerControlListModel();
+
+	QSet<ComputerControlInterface *> visibleComputerControlInterfaces;
+
+	const auto visibleIndexes = ui->listView->visibleIndexes();
+	for( const auto& index : visibleIndexes )
+	{
+		const auto controlInterface = computerControlListModel.computerControlInterface( m_sortFilterProxyModel.mapToSource( index ) );
+		if( controlInterface )
+		{
+			visibleComputerControlInterfaces.insert( controlInterface.data() );
+		}
+	}
+
+	// computers scrolled out of view or hidden by search filter do not need framebuffer updates
+	for( const auto& controlInterface : computerControlListModel.computerControlInterfaces() )
+	{
+		controlInterface->setUpdatesPaused( visibleComputerControlInterfaces.contains( controlInterface.data() ) == false );
+	}
+}
+
+
+
+void ComputerMonitoringView::updateFocusedComputer( const QModelIndex& current, const QModelIndex& previous )
+{
+	const auto& computerControlListModel = m_master->computerControlListModel();
+
+	// the current computer is the one the user interacts with so prefer its connection
+	if( previous.isValid() )
+	{
+		const auto controlInterface = computerControlListModel.computerControlInterface( m_sortFilterProxyModel.mapToSource( previous ) );
+		if( controlInterface )
+		{
+			controlInterface->setFocused( false );
+		}
+	}
+
+	if( current.isValid() )
+	{
+		const auto controlInterface = computerControlListModel.computerControlInterface( m_sortFilterProxyModel.mapToSource( current ) );
+		if( controlInterface )
+		{
+			controlInterface->setFocused( true );
+		}
+	}
+}
+
+
+
 void ComputerMonitoringView::runDoubleClickFeature( const QModelIndex& index )
 {
 	const Feature& feature = m_master->featureManager().feature( VeyonCore::config().computerDoubleClickFeature() );
@@ -26,6 +26,7 @@
 #define COMPUTER_MONITORING_VIEW_H
 
 #include "ComputerControlInterface.h"
+#include "ComputerMonitoringItemDelegate.h"
 
 #include <QSortFilterProxyModel>
 #include <QWidget>
@@ -66,6 +67,8 @@ private slots:
 	void runDoubleClickFeature( const QModelIndex& index );
 	void showContextMenu( QPoint pos );
 	void runFeature( const Feature& feature );
+	void updateVisibleComputers();
+	void updateFocusedComputer( const QModelIndex& current, const QModelIndex& previous );
 
 private:
 	void showEvent( QShowEvent* event ) override;
@@ -82,6 +85,7 @@ private:
 	VeyonMaster* m_master;
 	QMenu* m_featureMenu;
 	QSortFilterProxyModel m_sortFilterProxyModel;
+	ComputerMonitoringItemDelegate m_itemDelegate;
 
 signals:
 	void computerScreenSizeAdjusted( int size );
@@ -31,9 +31,16 @@
 
 FlexibleListView::FlexibleListView( QWidget* parent ) :
 	QListView( parent ),
-	m_uidRole( Qt::UserRole )
+	m_uidRole( Qt::UserRole ),
+	m_visibleIndexesUpdateTimer( this )
 {
 	connect( this, &QListView::indexesMoved, this, &FlexibleListView::updatePositions );
+	connect( this, &QListView::indexesMoved, this, &FlexibleListView::scheduleVisibleIndexesUpdate );
+
+	// debounce visibility changes while scrolling, resizing or filtering
+	m_visibleIndexesUpdateTimer.setSingleShot( true );
+	m_visibleIndexesUpdateTimer.setInterval( VisibleIndexesUpdateDelay );
+	connect( &m_visibleIndexesUpdateTimer, &QTimer::timeout, this, &FlexibleListView::visibleIndexesChanged );
 }
 
 
@@ -129,6 +136,33 @@ void FlexibleListView::loadPositions( const QJsonArray& data )
 
 
 
+QModelIndexList FlexibleListView::visibleIndexes() const
+{
+	QModelIndexList indexes;
+
+	auto m = model();
+
+	if( m == nullptr || isVisible() == false )
+	{
+		return indexes;
+	}
+
+	const auto viewportRect = viewport()->rect();
+
+	for( int i = 0, count = m->rowCount(); i < count; ++i )
+	{
+		const auto index = m->index( i, 0 );
+		if( isIndexHidden( index ) == false && visualRect( index ).intersects( viewportRect ) )
+		{
+			indexes.append( index );
+		}
+	}
+
+	return indexes;
+}
+
+
+
 void FlexibleListView::doItemsLayout()
 {
 	QListView::doItemsLayout();
@@ -137,6 +171,68 @@ void FlexibleListView::doItemsLayout()
 	{
 		restorePositions();
 	}
+
+	scheduleVisibleIndexesUpdate();
+}
+
+
+
+void FlexibleListView::setModel( QAbstractItemModel* model )
+{
+	if( this->model() )
+	{
+		disconnect( this->model(), nullptr, &m_visibleIndexesUpdateTimer, nullptr );
+	}
+
+	QListView::setModel( model );
+
+	if( model )
+	{
+		const auto start = static_cast<void (QTimer::*)()>( &QTimer::start );
+		connect( model, &QAbstractItemModel::rowsInserted, &m_visibleIndexesUpdateTimer, start );
+		connect( model, &QAbstractItemModel::rowsRemoved, &m_visibleIndexesUpdateTimer, start );
+		connect( model, &QAbstractItemModel::rowsMoved, &m_visibleIndexesUpdateTimer, start );
+		connect( model, &QAbstractItemModel::layoutChanged, &m_visibleIndexesUpdateTimer, start );
+		connect( model, &QAbstractItemModel::modelReset, &m_visibleIndexesUpdateTimer, start );
+	}
+
+	scheduleVisibleIndexesUpdate();
+}
+
+
+
+void FlexibleListView::scrollContentsBy( int dx, int dy )
+{
+	QListView::scrollContentsBy( dx, dy );
+
+	scheduleVisibleIndexesUpdate();
+}
+
+
+
+void FlexibleListView::resizeEvent( QResizeEvent* event )
+{
+	QListView::resizeEvent( event );
+
+	scheduleVisibleIndexesUpdate();
+}
+
+
+
+void FlexibleListView::showEvent( QShowEvent* event )
+{
+	QListView::showEvent( event );
+
+	scheduleVisibleIndexesUpdate();
+}
+
+
+
+void FlexibleListView::hideEvent( QHideEvent* event )
+{
+	QListView::hideEvent( event );
+
+	scheduleVisibleIndexesUpdate();
 }
 
 
@@ -185,6 +281,13 @@ void FlexibleListView::updatePositions()
 
 
 
+void FlexibleListView::scheduleVisibleIndexesUpdate()
+{
+	m_visibleIndexesUpdateTimer.start();
+}
+
+
+
 QSizeF FlexibleListView::effectiveGridSize() const
 {
 	auto m = model();
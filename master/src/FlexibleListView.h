@@ -26,11 +26,16 @@
 #define FLEXIBLE_LIST_VIEW_H
 
 #include <QListView>
+#include <QTimer>
 
 class FlexibleListView : public QListView
 {
 	Q_OBJECT
 public:
+	enum {
+		VisibleIndexesUpdateDelay = 250
+	};
+
 	FlexibleListView( QWidget *parent = nullptr );
 	~FlexibleListView() override;
 
@@ -44,12 +49,22 @@ public:
 	QJsonArray savePositions();
 	void loadPositions( const QJsonArray& data );
 
+	QModelIndexList visibleIndexes() const;
+
 public:
 	void doItemsLayout() override;
+	void setModel( QAbstractItemModel* model ) override;
+
+protected:
+	void scrollContentsBy( int dx, int dy ) override;
+	void resizeEvent( QResizeEvent* event ) override;
+	void showEvent( QShowEvent* event ) override;
+	void hideEvent( QHideEvent* event ) override;
 
 private:
 	void restorePositions();
 	void updatePositions();
+	void scheduleVisibleIndexesUpdate();
 
 private:
 	QSizeF effectiveGridSize() const;
@@ -58,6 +73,10 @@ private:
 
 	int m_uidRole;
 	QHash<QUuid, QPointF> m_positions;
+	QTimer m_visibleIndexesUpdateTimer;
+
+signals:
+	void visibleIndexesChanged();
 
 };
 
@@ -25,9 +25,11 @@
 #include <QCloseEvent>
 #include <QKeyEvent>
 #include <QHostAddress>
+#include <QLabel>
 #include <QMenu>
 #include <QMessageBox>
 #include <QSplitter>
+#include <QTimer>
 
 #include "AboutDialog.h"
 #include "AccessControlProvider.h"
@@ -80,6 +82,17 @@ MainWindow::MainWindow( VeyonMaster &masterCore, QWidget* parent ) :
 	ui->statusBar->addWidget( ui->spacerLabel4 );
 	ui->statusBar->addWidget( ui->aboutButton );
 
+	// show startup progress in a label of its own as QStatusBar::showMessage() hides all other widgets
+	auto startupProgressLabel = new QLabel( ui->statusBar );
+	ui->statusBar->addWidget( startupProgressLabel );
+
+	connect( &m_master.computerManager(), &ComputerManager::startupProgress,
+			 startupProgressLabel, [startupProgressLabel]( int stage ) {
+		startupProgressLabel->setText( ComputerManager::startupStageDescription( stage ) );
+	} );
+	connect( &m_master.computerManager(), &ComputerManager::startupFinished,
+			 startupProgressLabel, &QObject::deleteLater );
+
 	// create all views
 	auto splitter = new QSplitter( Qt::Horizontal, ui->centralWidget );
 	splitter->setChildrenCollapsible( false );
@@ -254,7 +267,7 @@ void MainWindow::keyPressEvent( QKeyEvent* event )
 	switch( event->key() )
 	{
 	case Qt::Key_F5:
-		VeyonCore::networkObjectDirectoryManager().configuredDirectory()->update();
+		VeyonCore::networkObjectDirectoryManager().configuredDirectory()->updateInBackground();
 		m_master.computerControlListModel().reload();
 		event->accept();
 		break;
@@ -270,6 +283,16 @@ void MainWindow::keyPressEvent( QKeyEvent* event )
 
 
 
+void MainWindow::showEvent( QShowEvent* event )
+{
+	QMainWindow::showEvent( event );
+
+	// load directory and restore selection not before the window has been painted for the first time
+	QTimer::singleShot( 0, &m_master.computerManager(), &ComputerManager::startup );
+}
+
+
+
 void MainWindow::handleSystemTrayEvent( QSystemTrayIcon::ActivationReason reason )
 {
 	switch( reason )
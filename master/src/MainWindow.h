@@ -60,6 +60,7 @@ public:
 protected:
 	void closeEvent( QCloseEvent* event ) override;
 	void keyPressEvent( QKeyEvent *e ) override;
+	void showEvent( QShowEvent* event ) override;
 
 
 private slots:
@@ -0,0 +1,95 @@
+/*
+ * ThumbnailCache.cpp - persistent cache for computer thumbnails
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include "ThumbnailCache.h"
+
+
+ThumbnailCache::ThumbnailCache() :
+	m_directory( QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) +
+				 QDir::separator() + QStringLiteral("thumbnails") )
+{
+	if( QDir().mkpath( m_directory ) == false )
+	{
+		qWarning() << "ThumbnailCache: could not create cache directory" << m_directory;
+	}
+}
+
+
+
+QImage ThumbnailCache::load( const QUuid& computerUid ) const
+{
+	return QImage( fileName( computerUid ), "JPEG" );
+}
+
+
+
+void ThumbnailCache::store( const ThumbnailMap& thumbnails )
+{
+	for( auto it = thumbnails.constBegin(); it != thumbnails.constEnd(); ++it )
+	{
+		// write to temporary file first so a thumbnail is never read partially
+		QSaveFile file( fileName( it.key() ) );
+		if( file.open( QSaveFile::WriteOnly ) == false ||
+				it.value().save( &file, "JPEG", JpegQuality ) == false ||
+				file.commit() == false )
+		{
+			qWarning() << "ThumbnailCache::store(): could not write" << file.fileName();
+		}
+	}
+
+	evict();
+}
+
+
+
+QString ThumbnailCache::fileName( const QUuid& computerUid ) const
+{
+	// strip curly braces
+	return m_directory + QDir::separator() + computerUid.toString().mid( 1, 36 ) + QStringLiteral(".jpg");
+}
+
+
+
+void ThumbnailCache::evict()
+{
+	// newest files first
+	const auto files = QDir( m_directory ).entryInfoList( { QStringLiteral("*.jpg") }, QDir::Files, QDir::Time );
+
+	qint64 totalSize = 0;
+
+	for( const auto& file : files )
+	{
+		totalSize += file.size();
+		if( totalSize > MaximumCacheSize )
+		{
+			QFile::remove( file.absoluteFilePath() );
+		}
+	}
+}
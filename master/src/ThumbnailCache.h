@@ -0,0 +1,68 @@
+/*
+ * ThumbnailCache.h - persistent cache for computer thumbnails
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef THUMBNAIL_CACHE_H
+#define THUMBNAIL_CACHE_H
+
+#include <QHash>
+#include <QImage>
+#include <QUuid>
+
+// clazy:excludeall=rule-of-three
+
+/*!
+ * \brief Stores the most recent thumbnail of each computer as JPEG file in the user's cache directory
+ *
+ * Cached thumbnails are shown while the connection to a computer is being established or the
+ * computer is offline. The total size of the cache is limited by removing least recently stored
+ * thumbnails. Thumbnails can be stored and loaded from different background threads at the same
+ * time, as all operations work on separate files only.
+ */
+class ThumbnailCache
+{
+public:
+	typedef QHash<QUuid, QImage> ThumbnailMap;
+
+	enum {
+		JpegQuality = 75,
+		MaximumCacheSize = 32 * 1024 * 1024,
+	};
+
+	ThumbnailCache();
+
+	/** \brief Returns the cached thumbnail of given computer or a null image if there is none */
+	QImage load( const QUuid& computerUid ) const;
+
+	/** \brief Writes given thumbnails to disk and evicts old thumbnails afterwards */
+	void store( const ThumbnailMap& thumbnails );
+
+private:
+	QString fileName( const QUuid& computerUid ) const;
+	void evict();
+
+	const QString m_directory;
+
+} ;
+
+#endif
@@ -22,6 +22,7 @@
  *
  */
 
+#include "VeyonConfiguration.h"
 #include "BuiltinDirectoryConfiguration.h"
 #include "BuiltinDirectory.h"
 
@@ -34,19 +35,40 @@ BuiltinDirectory::BuiltinDirectory( BuiltinDirectoryConfiguration& configuration
 
 
 
-QList<NetworkObject> BuiltinDirectory::objects( const NetworkObject& parent )
+BuiltinDirectory::ObjectMap BuiltinDirectory::fetchObjects()
 {
-	if( parent.type() == NetworkObject::Root )
+	// read current objects through a configuration object of our own as reloading the
+	// global configuration would race with the main thread
+	VeyonConfiguration storedConfiguration;
+
+	const auto networkObjects = BuiltinDirectoryConfiguration( &storedConfiguration ).networkObjects();
+
+	ObjectMap objects;
+	QHash<NetworkObject::Uid, NetworkObject> rooms;
+
+	for( const auto& networkObjectValue : networkObjects )
 	{
-		return m_objects.keys();
+		const NetworkObject networkObject( networkObjectValue.toObject() );
+
+		if( networkObject.type() == NetworkObject::Group )
+		{
+			rooms[networkObject.uid()] = networkObject;
+			objects[networkObject] = QList<NetworkObject>();
+		}
 	}
-	else if( parent.type() == NetworkObject::Group &&
-			 m_objects.contains( parent ) )
+
+	for( const auto& networkObjectValue : networkObjects )
 	{
-		return qAsConst(m_objects)[parent];
+		const NetworkObject networkObject( networkObjectValue.toObject() );
+		const auto room = rooms.constFind( networkObject.parentUid() );
+
+		if( networkObject.type() != NetworkObject::Group && room != rooms.constEnd() )
+		{
+			objects[*room].append( networkObject ); // clazy:exclude=reserve-candidates
+		}
 	}
 
-	return QList<NetworkObject>();
+	return objects;
 }
 
 
@@ -91,102 +113,3 @@ NetworkObject BuiltinDirectory::queryParent( const NetworkObject& object )
 
 	return NetworkObject();
 }
-
-
-
-void BuiltinDirectory::update()
-{
-	m_configuration.reloadFromStore();
-
-	const auto networkObjects = m_configuration.networkObjects();
-
-	const NetworkObject rootObject( NetworkObject::Root );
-
-	QVector<NetworkObject::Uid> roomUids;
-
-	for( const auto& networkObjectValue : networkObjects )
-	{
-		const NetworkObject networkObject( networkObjectValue.toObject() );
-
-		if( networkObject.type() == NetworkObject::Group )
-		{
-			roomUids.append( networkObject.uid() ); // clazy:exclude=reserve-candidates
-
-			if( m_objects.contains( networkObject ) == false )
-			{
-				emit objectsAboutToBeInserted( rootObject, m_objects.count(), 1 );
-				m_objects[networkObject] = QList<NetworkObject>();
-				emit objectsInserted();
-			}
-
-			updateRoom( networkObject );
-		}
-	}
-
-	int index = 0;
-	for( auto it = m_objects.begin(); it != m_objects.end(); ) // clazy:exclude=detaching-member
-	{
-		if( it.key().type() == NetworkObject::Group &&
-				roomUids.contains( it.key().uid() ) == false )
-		{
-			emit objectsAboutToBeRemoved( rootObject, index, 1 );
-			it = m_objects.erase( it );
-			emit objectsRemoved();
-		}
-		else
-		{
-			++it;
-			++index;
-		}
-	}
-}
-
-
-
-void BuiltinDirectory::updateRoom( const NetworkObject& roomObject )
-{
-	const auto networkObjects = m_configuration.networkObjects();
-
-	QList<NetworkObject>& computerObjects = m_objects[roomObject]; // clazy:exclude=detaching-member
-
-	QVector<NetworkObject::Uid> computerUids;
-
-	for( const auto& networkObjectValue : networkObjects )
-	{
-		NetworkObject networkObject( networkObjectValue.toObject() );
-
-		if( networkObject.parentUid() == roomObject.uid() )
-		{
-			computerUids.append( networkObject.uid() ); // clazy:exclude=reserve-candidates
-
-			int index = computerObjects.indexOf( networkObject );
-			if( index < 0 )
-			{
-				emit objectsAboutToBeInserted( roomObject, computerObjects.count(), 1 );
-				computerObjects += networkObject; // clazy:exclude=reserve-candidates
-				emit objectsInserted();
-			}
-			else if( computerObjects[index].exactMatch( networkObject ) == false )
-			{
-				computerObjects.replace( index, networkObject );
-				emit objectChanged( roomObject, index );
-			}
-		}
-	}
-
-	int index = 0;
-	for( auto it = computerObjects.begin(); it != computerObjects.end(); )
-	{
-		if( computerUids.contains( it->uid() ) == false )
-		{
-			emit objectsAboutToBeRemoved( roomObject, index, 1 );
-			it = computerObjects.erase( it );
-			emit objectsRemoved();
-		}
-		else
-		{
-			++it;
-			++index;
-		}
-	}
-}
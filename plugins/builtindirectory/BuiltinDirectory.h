@@ -25,8 +25,6 @@
 #ifndef BUILTIN_DIRECTORY_H
 #define BUILTIN_DIRECTORY_H
 
-#include <QHash>
-
 #include "NetworkObjectDirectory.h"
 
 class BuiltinDirectoryConfiguration;
@@ -37,18 +35,13 @@ class BuiltinDirectory : public NetworkObjectDirectory
 public:
 	BuiltinDirectory( BuiltinDirectoryConfiguration& configuration, QObject* parent );
 
-	QList<NetworkObject> objects( const NetworkObject& parent ) override;
+	ObjectMap fetchObjects() override;
 
 	QList<NetworkObject> queryObjects( NetworkObject::Type type, const QString& name ) override;
 	NetworkObject queryParent( const NetworkObject& object ) override;
 
-	void update() override;
-
 private:
-	void updateRoom( const NetworkObject& roomObject );
-
 	BuiltinDirectoryConfiguration& m_configuration;
-	QHash<NetworkObject, QList<NetworkObject>> m_objects;
 };
 
 #endif // BUILTIN_DIRECTORY_H
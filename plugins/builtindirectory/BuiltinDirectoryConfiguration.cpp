@@ -32,4 +32,11 @@ BuiltinDirectoryConfiguration::BuiltinDirectoryConfiguration() :
 }
 
 
+
+BuiltinDirectoryConfiguration::BuiltinDirectoryConfiguration( Configuration::Object* object ) :
+	Configuration::Proxy( object )
+{
+}
+
+
 FOREACH_BUILTIN_DIRECTORY_CONFIG_PROPERTY(IMPLEMENT_CONFIG_SET_PROPERTY)
@@ -39,6 +39,7 @@ class BuiltinDirectoryConfiguration : public Configuration::Proxy
 	Q_OBJECT
 public:
 	BuiltinDirectoryConfiguration();
+	explicit BuiltinDirectoryConfiguration( Configuration::Object* object );
 
 	FOREACH_BUILTIN_DIRECTORY_CONFIG_PROPERTY(DECLARE_CONFIG_PROPERTY)
 
@@ -30,25 +30,41 @@
 LdapNetworkObjectDirectory::LdapNetworkObjectDirectory( const LdapConfiguration& ldapConfiguration,
 														QObject* parent ) :
 	NetworkObjectDirectory( parent ),
+	m_configuration( ldapConfiguration ),
 	m_ldapDirectory( ldapConfiguration )
 {
 }
 
 
 
-QList<NetworkObject> LdapNetworkObjectDirectory::objects( const NetworkObject& parent )
+LdapNetworkObjectDirectory::ObjectMap LdapNetworkObjectDirectory::fetchObjects()
 {
-	if( parent.type() == NetworkObject::Root )
-	{
-		return m_objects.keys();
-	}
-	else if( parent.type() == NetworkObject::Group &&
-			 m_objects.contains( parent ) )
+	// use a connection of our own as LDAP connections must not be shared between threads
+	LdapDirectory ldapDirectory( m_configuration );
+
+	const auto hasMacAddressAttribute = ( m_configuration.computerMacAddressAttribute().count() > 0 );
+	const auto computerRooms = ldapDirectory.computerRooms();
+
+	ObjectMap objects;
+
+	for( const auto& computerRoom : computerRooms )
 	{
-		return qAsConst(m_objects)[parent];
+		QList<NetworkObject> computerObjects;
+
+		const auto computers = ldapDirectory.computerRoomMembers( computerRoom );
+		for( const auto& computer : computers )
+		{
+			const auto computerObject = computerToObject( ldapDirectory, computer, hasMacAddressAttribute );
+			if( computerObject.type() == NetworkObject::Host )
+			{
+				computerObjects.append( computerObject ); // clazy:exclude=reserve-candidates
+			}
+		}
+
+		objects[NetworkObject( NetworkObject::Group, computerRoom )] = computerObjects;
 	}
 
-	return QList<NetworkObject>();
+	return objects;
 }
 
 
@@ -85,94 +101,6 @@ NetworkObject LdapNetworkObjectDirectory::queryParent( const NetworkObject& obje
 
 
 
-void LdapNetworkObjectDirectory::update()
-{
-	const auto computerRooms = m_ldapDirectory.computerRooms();
-	const NetworkObject rootObject( NetworkObject::Root );
-
-	for( const auto& computerRoom : qAsConst( computerRooms ) )
-	{
-		NetworkObject computerRoomObject( NetworkObject::Group, computerRoom );
-
-		if( m_objects.contains( computerRoomObject ) == false )
-		{
-			emit objectsAboutToBeInserted( rootObject, m_objects.count(), 1 );
-			m_objects[computerRoomObject] = QList<NetworkObject>();
-			emit objectsInserted();
-		}
-
-		updateComputerRoom( computerRoom );
-	}
-
-	int index = 0;
-	for( auto it = m_objects.begin(); it != m_objects.end(); )	// clazy:exclude=detaching-member
-	{
-		if( computerRooms.contains( it.key().name() ) == false )
-		{
-			emit objectsAboutToBeRemoved( rootObject, index, 1 );
-			it = m_objects.erase( it );
-			emit objectsRemoved();
-		}
-		else
-		{
-			++it;
-			++index;
-		}
-	}
-}
-
-
-
-void LdapNetworkObjectDirectory::updateComputerRoom( const QString& computerRoom )
-{
-	const NetworkObject computerRoomObject( NetworkObject::Group, computerRoom );
-	QList<NetworkObject>& computerRoomObjects = m_objects[computerRoomObject]; // clazy:exclude=detaching-member
-
-	const auto computers = m_ldapDirectory.computerRoomMembers( computerRoom );
-
-	bool hasMacAddressAttribute = ( m_ldapDirectory.configuration().computerMacAddressAttribute().count() > 0 );
-
-	for( const auto& computer : qAsConst( computers ) )
-	{
-		const auto computerObject = computerToObject( computer, hasMacAddressAttribute );
-		if( computerObject.type() != NetworkObject::Host )
-		{
-			continue;
-		}
-
-		const auto index = computerRoomObjects.indexOf( computerObject );
-		if( index < 0 )
-		{
-			emit objectsAboutToBeInserted( computerRoomObject, computerRoomObjects.count(), 1 );
-			computerRoomObjects += computerObject; // clazy:exclude=reserve-candidates
-			emit objectsInserted();
-		}
-		else if( computerRoomObjects[index].exactMatch( computerObject ) == false )
-		{
-			computerRoomObjects.replace( index, computerObject );
-			emit objectChanged( computerRoomObject, index );
-		}
-	}
-
-	int index = 0;
-	for( auto it = computerRoomObjects.begin(); it != computerRoomObjects.end(); )
-	{
-		if( computers.contains( it->directoryAddress() ) == false )
-		{
-			emit objectsAboutToBeRemoved( computerRoomObject, index, 1 );
-			it = computerRoomObjects.erase( it );
-			emit objectsRemoved();
-		}
-		else
-		{
-			++it;
-			++index;
-		}
-	}
-}
-
-
-
 QList<NetworkObject> LdapNetworkObjectDirectory::queryGroups( const QString& name )
 {
 	const auto groups = m_ldapDirectory.computerRooms( name );
@@ -199,7 +127,7 @@ QList<NetworkObject> LdapNetworkObjectDirectory::queryHosts( const QString& name
 
 	for( const auto& computer : computers )
 	{
-		hostObjects.append( computerToObject( computer, false ) );
+		hostObjects.append( computerToObject( m_ldapDirectory, computer, false ) );
 	}
 
 	return hostObjects;
@@ -207,9 +135,10 @@ QList<NetworkObject> LdapNetworkObjectDirectory::queryHosts( const QString& name
 
 
 
-NetworkObject LdapNetworkObjectDirectory::computerToObject( const QString& computerDn, bool populateMacAddres )
+NetworkObject LdapNetworkObjectDirectory::computerToObject( LdapDirectory& ldapDirectory,
+															 const QString& computerDn, bool populateMacAddres )
 {
-	const auto computerHostName = m_ldapDirectory.computerHostName( computerDn );
+	const auto computerHostName = ldapDirectory.computerHostName( computerDn );
 	if( computerHostName.isEmpty() )
 	{
 		return NetworkObject::None;
@@ -218,7 +147,7 @@ NetworkObject LdapNetworkObjectDirectory::computerToObject( const QString& compu
 	QString computerMacAddress;
 	if( populateMacAddres )
 	{
-		computerMacAddress = m_ldapDirectory.computerMacAddress( computerDn );
+		computerMacAddress = ldapDirectory.computerMacAddress( computerDn );
 	}
 
 	return NetworkObject( NetworkObject::Host,
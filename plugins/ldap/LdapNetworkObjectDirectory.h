@@ -25,8 +25,6 @@
 #ifndef LDAP_NETWORK_OBJECT_DIRECTORY_H
 #define LDAP_NETWORK_OBJECT_DIRECTORY_H
 
-#include <QHash>
-
 #include "LdapDirectory.h"
 #include "NetworkObjectDirectory.h"
 
@@ -36,23 +34,19 @@ class LdapNetworkObjectDirectory : public NetworkObjectDirectory
 public:
 	LdapNetworkObjectDirectory( const LdapConfiguration& ldapConfiguration, QObject* parent );
 
-	QList<NetworkObject> objects( const NetworkObject& parent ) override;
+	ObjectMap fetchObjects() override;
 
 	QList<NetworkObject> queryObjects( NetworkObject::Type type, const QString& name ) override;
 	NetworkObject queryParent( const NetworkObject& object ) override;
 
-private slots:
-	void update() override;
-	void updateComputerRoom( const QString& computerRoom );
-
 private:
 	QList<NetworkObject> queryGroups( const QString& name );
 	QList<NetworkObject> queryHosts( const QString& name );
 
-	NetworkObject computerToObject( const QString& computerDn, bool populateMacAddres );
+	static NetworkObject computerToObject( LdapDirectory& ldapDirectory, const QString& computerDn, bool populateMacAddres );
 
+	const LdapConfiguration& m_configuration;
 	LdapDirectory m_ldapDirectory;
-	QHash<NetworkObject, QList<NetworkObject>> m_objects;
 };
 
 #endif // LDAP_NETWORK_OBJECT_DIRECTORY_H
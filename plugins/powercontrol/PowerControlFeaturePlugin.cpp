@@ -81,6 +81,7 @@ bool PowerControlFeaturePlugin::startFeature( VeyonMasterInterface& master, cons
 		for( auto controlInterface : computerControlInterfaces )
 		{
 			broadcastWOLPacket( controlInterface->computer().macAddress() );
+			controlInterface->resetReconnectBackoff();
 		}
 	}
 	else
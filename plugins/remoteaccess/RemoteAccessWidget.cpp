@@ -378,5 +378,7 @@ void RemoteAccessWidget::toggleViewOnly( bool viewOnly )
 
 void RemoteAccessWidget::takeScreenshot()
 {
-	Screenshot().take( m_computerControlInterface );
+	auto screenshot = new Screenshot( QString(), this );
+	connect( screenshot, &Screenshot::finished, screenshot, &QObject::deleteLater );
+	screenshot->take( m_computerControlInterface );
 }
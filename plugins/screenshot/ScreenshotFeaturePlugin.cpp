@@ -23,6 +23,8 @@
  */
 
 #include <QMessageBox>
+#include <QPointer>
+#include <QSharedPointer>
 
 #include "ScreenshotFeaturePlugin.h"
 #include "ComputerControlInterface.h"
@@ -56,17 +58,34 @@ bool ScreenshotFeaturePlugin::startFeature( VeyonMasterInterface& master, const
 {
 	if( feature.uid() == m_screenshotFeature.uid() )
 	{
+		// screens are grabbed asynchronously so report results not before the last screenshot has finished
+		const auto screenshotCount = computerControlInterfaces.count();
+		const auto finishedCount = QSharedPointer<int>::create( 0 );
+		const auto successCount = QSharedPointer<int>::create( 0 );
+		const QPointer<QWidget> mainWindow( master.mainWindow() );
+
 		for( auto controlInterface : computerControlInterfaces )
 		{
-			Screenshot().take( controlInterface );
-
+			auto screenshot = new Screenshot( QString(), this );
+			connect( screenshot, &Screenshot::finished, this, [=]() {
+				if( screenshot->isValid() )
+				{
+					++*successCount;
+				}
+
+				screenshot->deleteLater();
+
+				if( ++*finishedCount == screenshotCount )
+				{
+					QMessageBox::information( mainWindow,
+											  tr( "Screenshots taken" ),
+											  tr( "Screenshot of %1 computer have been taken successfully." ).
+											  arg( *successCount ) );
+				}
+			} );
+			screenshot->take( controlInterface );
 		}
 
-		QMessageBox::information( master.mainWindow(),
-								  tr( "Screenshots taken" ),
-								  tr( "Screenshot of %1 computer have been taken successfully." ).
-								  arg( computerControlInterfaces.count() ) );
-
 		return true;
 	}
 
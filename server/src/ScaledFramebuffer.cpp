@@ -0,0 +1,402 @@
+/*
+ * ScaledFramebuffer.cpp - implementation of ScaledFramebuffer class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QBuffer>
+#include <QtEndian>
+
+#include "FramebufferScaler.h"
+#include "ScaledFramebuffer.h"
+
+
+ScaledFramebuffer::ScaledFramebuffer( QSize framebufferSize, QSize scaledSize ) :
+	m_framebuffer( framebufferSize, QImage::Format_RGB32 ),
+	m_scaledFramebuffer(),
+	m_scaledSize( scaledSize ),
+	m_damage(),
+	m_sizeChanged( true ),
+	m_clientFramebufferScaled( false ),
+	m_jpegQuality( -1 )
+{
+	m_framebuffer.fill( Qt::black );
+}
+
+
+
+bool ScaledFramebuffer::isPixelFormatSupported( const rfbPixelFormat& format )
+{
+	// pixel layout has to match QImage::Format_RGB32
+	return format.bitsPerPixel == 32 &&
+			format.trueColour &&
+			format.bigEndian == 0 &&
+			qFromBigEndian( format.redMax ) == 0xff &&
+			qFromBigEndian( format.greenMax ) == 0xff &&
+			qFromBigEndian( format.blueMax ) == 0xff &&
+			format.redShift == 16 &&
+			format.greenShift == 8 &&
+			format.blueShift == 0;
+}
+
+
+
+int ScaledFramebuffer::jpegQualityForLevel( int qualityLevel )
+{
+	static const int jpegQualities[] = { 5, 10, 15, 25, 37, 50, 60, 70, 75, 80 };
+
+	return jpegQualities[qBound( 0, qualityLevel, 9 )];
+}
+
+
+
+void ScaledFramebuffer::setScaledSize( QSize scaledSize )
+{
+	if( scaledSize != m_scaledSize )
+	{
+		m_scaledSize = scaledSize;
+		m_sizeChanged = true;
+	}
+}
+
+
+
+void ScaledFramebuffer::resize( QSize framebufferSize )
+{
+	if( framebufferSize != m_framebuffer.size() )
+	{
+		m_framebuffer = QImage( framebufferSize, QImage::Format_RGB32 );
+		m_framebuffer.fill( Qt::black );
+		m_sizeChanged = true;
+	}
+}
+
+
+
+bool ScaledFramebuffer::handleFramebufferUpdate( const QByteArray& message )
+{
+	QBuffer buffer;
+	buffer.setData( message );
+	buffer.open( QBuffer::ReadOnly ); // Flawfinder: ignore
+
+	rfbFramebufferUpdateMsg updateMessage;
+	if( buffer.read( reinterpret_cast<char *>( &updateMessage ), sz_rfbFramebufferUpdateMsg ) != sz_rfbFramebufferUpdateMsg )
+	{
+		return false;
+	}
+
+	const int nRects = qFromBigEndian( updateMessage.nRects );
+
+	for( int i = 0; i < nRects; ++i )
+	{
+		rfbFramebufferUpdateRectHeader rectHeader;
+		if( buffer.read( reinterpret_cast<char *>( &rectHeader ), sz_rfbFramebufferUpdateRectHeader ) != sz_rfbFramebufferUpdateRectHeader )
+		{
+			return false;
+		}
+
+		const QRect rect( qFromBigEndian( rectHeader.r.x ), qFromBigEndian( rectHeader.r.y ),
+						  qFromBigEndian( rectHeader.r.w ), qFromBigEndian( rectHeader.r.h ) );
+
+		switch( static_cast<int32_t>( qFromBigEndian( rectHeader.encoding ) ) )
+		{
+		case rfbEncodingLastRect:
+			return true;
+
+		case rfbEncodingRaw:
+			if( applyRawRect( buffer, rect ) == false )
+			{
+				return false;
+			}
+			break;
+
+		case rfbEncodingCopyRect:
+			if( applyCopyRect( buffer, rect ) == false )
+			{
+				return false;
+			}
+			break;
+
+		case rfbEncodingNewFBSize:
+			resize( rect.size() );
+			break;
+
+		default:
+			// rect can't be decoded (e.g. update which has been requested before changing encodings)
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+
+QByteArray ScaledFramebuffer::scaledFramebufferUpdate()
+{
+	const auto scaledSize = effectiveScaledSize( m_framebuffer.size(), m_scaledSize );
+	if( scaledSize.isEmpty() )
+	{
+		return QByteArray();
+	}
+
+	QVector<QRect> rects;
+
+	if( m_sizeChanged || m_scaledFramebuffer.size() != scaledSize )
+	{
+		m_scaledFramebuffer = QImage( scaledSize, QImage::Format_RGB32 );
+		FramebufferScaler::scale( m_framebuffer, m_scaledFramebuffer, m_scaledFramebuffer.rect() );
+		rects.append( m_scaledFramebuffer.rect() );
+	}
+	else if( m_damage.isEmpty() == false )
+	{
+		QRegion scaledDamage;
+		const auto damagedRects = m_damage.rects();
+		for( const auto& rect : damagedRects )
+		{
+			scaledDamage += FramebufferScaler::mapToTarget( rect, m_framebuffer.size(), scaledSize );
+		}
+
+		if( scaledDamage.rectCount() > MaximumRectCount )
+		{
+			scaledDamage = scaledDamage.boundingRect();
+		}
+
+		const auto scaledRects = scaledDamage.rects();
+		for( const auto& rect : scaledRects )
+		{
+			FramebufferScaler::scale( m_framebuffer, m_scaledFramebuffer, rect );
+			rects.append( rect );
+		}
+	}
+
+	m_damage = QRegion();
+
+	if( rects.isEmpty() )
+	{
+		return QByteArray();
+	}
+
+	QByteArray message;
+	QBuffer buffer( &message );
+	buffer.open( QBuffer::WriteOnly );
+
+	rfbFramebufferUpdateMsg updateMessage;
+	updateMessage.type = rfbFramebufferUpdate;
+	updateMessage.pad = 0;
+	updateMessage.nRects = qToBigEndian<uint16_t>( static_cast<uint16_t>( rects.size() + ( m_sizeChanged ? 1 : 0 ) ) );
+	buffer.write( reinterpret_cast<const char *>( &updateMessage ), sz_rfbFramebufferUpdateMsg );
+
+	if( m_sizeChanged )
+	{
+		rfbFramebufferUpdateRectHeader rectHeader;
+		rectHeader.r.x = 0;
+		rectHeader.r.y = 0;
+		rectHeader.r.w = qToBigEndian<uint16_t>( static_cast<uint16_t>( scaledSize.width() ) );
+		rectHeader.r.h = qToBigEndian<uint16_t>( static_cast<uint16_t>( scaledSize.height() ) );
+		rectHeader.encoding = qToBigEndian<uint32_t>( rfbEncodingNewFBSize );
+		buffer.write( reinterpret_cast<const char *>( &rectHeader ), sz_rfbFramebufferUpdateRectHeader );
+
+		m_sizeChanged = false;
+		m_clientFramebufferScaled = true;
+	}
+
+	for( const auto& rect : rects )
+	{
+		// JPEG does not pay off for tiny rects
+		if( m_jpegQuality >= 0 && rect.width() * rect.height() >= MinimumJpegRectArea &&
+				writeJpegRect( buffer, rect ) )
+		{
+			continue;
+		}
+
+		writeRectHeader( buffer, rect, rfbEncodingRaw );
+
+		for( int y = rect.top(); y <= rect.bottom(); ++y )
+		{
+			buffer.write( reinterpret_cast<const char *>( m_scaledFramebuffer.constScanLine( y ) ) + rect.x() * 4, rect.width() * 4 );
+		}
+	}
+
+	return message;
+}
+
+
+
+bool ScaledFramebuffer::writeJpegRect( QIODevice& device, const QRect& rect )
+{
+	QByteArray jpegData;
+	QBuffer jpegBuffer( &jpegData );
+	jpegBuffer.open( QBuffer::WriteOnly );
+
+	if( m_scaledFramebuffer.copy( rect ).save( &jpegBuffer, "JPEG", m_jpegQuality ) == false ||
+			jpegData.size() > MaximumTightDataLength )
+	{
+		return false;
+	}
+
+	writeRectHeader( device, rect, rfbEncodingTight );
+
+	const uint8_t compressionControl = rfbTightJpeg << 4;
+	device.write( reinterpret_cast<const char *>( &compressionControl ), 1 );
+
+	// write length in compact representation (7 bits per byte, MSB set if another byte follows)
+	const auto length = static_cast<uint32_t>( jpegData.size() );
+	uint8_t compactLength[3] = { static_cast<uint8_t>( length & 0x7f ), 0, 0 };
+	int compactLengthSize = 1;
+	if( length > 0x7f )
+	{
+		compactLength[0] |= 0x80;
+		compactLength[1] = static_cast<uint8_t>( ( length >> 7 ) & 0x7f );
+		++compactLengthSize;
+		if( length > 0x3fff )
+		{
+			compactLength[1] |= 0x80;
+			compactLength[2] = static_cast<uint8_t>( length >> 14 );
+			++compactLengthSize;
+		}
+	}
+
+	device.write( reinterpret_cast<const char *>( compactLength ), compactLengthSize );
+	device.write( jpegData );
+
+	return true;
+}
+
+
+
+void ScaledFramebuffer::writeRectHeader( QIODevice& device, const QRect& rect, int32_t encoding )
+{
+	rfbFramebufferUpdateRectHeader rectHeader;
+	rectHeader.r.x = qToBigEndian<uint16_t>( static_cast<uint16_t>( rect.x() ) );
+	rectHeader.r.y = qToBigEndian<uint16_t>( static_cast<uint16_t>( rect.y() ) );
+	rectHeader.r.w = qToBigEndian<uint16_t>( static_cast<uint16_t>( rect.width() ) );
+	rectHeader.r.h = qToBigEndian<uint16_t>( static_cast<uint16_t>( rect.height() ) );
+	rectHeader.encoding = qToBigEndian<uint32_t>( static_cast<uint32_t>( encoding ) );
+	device.write( reinterpret_cast<const char *>( &rectHeader ), sz_rfbFramebufferUpdateRectHeader );
+}
+
+
+
+QPoint ScaledFramebuffer::mapToFramebuffer( QPoint scaledPos ) const
+{
+	const auto scaledSize = m_scaledFramebuffer.size();
+	if( scaledSize.isEmpty() )
+	{
+		return scaledPos;
+	}
+
+	return QPoint( qBound( 0, scaledPos.x() * m_framebuffer.width() / scaledSize.width(), m_framebuffer.width() - 1 ),
+				   qBound( 0, scaledPos.y() * m_framebuffer.height() / scaledSize.height(), m_framebuffer.height() - 1 ) );
+}
+
+
+
+QByteArray ScaledFramebuffer::resizeFramebufferMessage( QSize size )
+{
+	QByteArray message( sz_rfbFramebufferUpdateMsg + sz_rfbFramebufferUpdateRectHeader, 0 );
+
+	auto updateMessage = reinterpret_cast<rfbFramebufferUpdateMsg *>( message.data() );
+	updateMessage->type = rfbFramebufferUpdate;
+	updateMessage->nRects = qToBigEndian<uint16_t>( 1 );
+
+	auto rectHeader = reinterpret_cast<rfbFramebufferUpdateRectHeader *>( message.data() + sz_rfbFramebufferUpdateMsg );
+	rectHeader->r.w = qToBigEndian<uint16_t>( static_cast<uint16_t>( size.width() ) );
+	rectHeader->r.h = qToBigEndian<uint16_t>( static_cast<uint16_t>( size.height() ) );
+	rectHeader->encoding = qToBigEndian<uint32_t>( rfbEncodingNewFBSize );
+
+	return message;
+}
+
+
+
+bool ScaledFramebuffer::applyRawRect( QIODevice& device, const QRect& rect )
+{
+	if( rect.isEmpty() )
+	{
+		return true;
+	}
+
+	if( m_framebuffer.rect().contains( rect ) == false )
+	{
+		return false;
+	}
+
+	for( int y = rect.top(); y <= rect.bottom(); ++y )
+	{
+		const qint64 lineSize = rect.width() * 4;
+		if( device.read( reinterpret_cast<char *>( m_framebuffer.scanLine( y ) ) + rect.x() * 4, lineSize ) != lineSize ) // Flawfinder: ignore
+		{
+			return false;
+		}
+	}
+
+	m_damage += rect;
+
+	return true;
+}
+
+
+
+bool ScaledFramebuffer::applyCopyRect( QIODevice& device, const QRect& rect )
+{
+	rfbCopyRect copyRect;
+	if( device.read( reinterpret_cast<char *>( &copyRect ), sz_rfbCopyRect ) != sz_rfbCopyRect ) // Flawfinder: ignore
+	{
+		return false;
+	}
+
+	if( rect.isEmpty() )
+	{
+		return true;
+	}
+
+	const QRect sourceRect( qFromBigEndian( copyRect.srcX ), qFromBigEndian( copyRect.srcY ), rect.width(), rect.height() );
+
+	if( m_framebuffer.rect().contains( rect ) == false ||
+			m_framebuffer.rect().contains( sourceRect ) == false )
+	{
+		return false;
+	}
+
+	// process lines in an order which does not overwrite source lines not copied yet
+	const bool bottomUp = sourceRect.y() < rect.y();
+
+	for( int i = 0; i < rect.height(); ++i )
+	{
+		const int line = bottomUp ? rect.height() - 1 - i : i;
+		memmove( m_framebuffer.scanLine( rect.y() + line ) + rect.x() * 4,
+				 m_framebuffer.constScanLine( sourceRect.y() + line ) + sourceRect.x() * 4,
+				 static_cast<size_t>( rect.width() * 4 ) );
+	}
+
+	m_damage += rect;
+
+	return true;
+}
+
+
+
+QSize ScaledFramebuffer::effectiveScaledSize( QSize framebufferSize, QSize scaledSize )
+{
+	// never scale up as the client can do this on its own
+	return scaledSize.boundedTo( framebufferSize );
+}
@@ -0,0 +1,120 @@
+/*
+ * ScaledFramebuffer.h - header file for ScaledFramebuffer class
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef SCALED_FRAMEBUFFER_H
+#define SCALED_FRAMEBUFFER_H
+
+#include <QImage>
+#include <QRegion>
+
+#include "rfb/rfbproto.h"
+
+#include "VeyonCore.h"
+
+class QIODevice;
+
+/*!
+ * \brief Maintains a copy of the server's framebuffer and generates downscaled framebuffer updates from it
+ *
+ * Framebuffer updates received from the VNC server (raw and CopyRect encoded) are applied to a local
+ * full resolution framebuffer. Only the parts of the scaled framebuffer which are affected by the received
+ * updates are rescaled and sent to the client as raw rects so thumbnail connections only transfer
+ * a fraction of the full resolution data. If the client supports Tight encoding with JPEG, larger
+ * rects are sent JPEG compressed instead.
+ */
+class ScaledFramebuffer
+{
+public:
+	enum {
+		MaximumRectCount = 64,
+		MinimumJpegRectArea = 16*16,
+		MaximumTightDataLength = 4194303,
+	};
+
+	ScaledFramebuffer( QSize framebufferSize, QSize scaledSize );
+
+	static bool isPixelFormatSupported( const rfbPixelFormat& format );
+
+	QSize scaledSize() const
+	{
+		return m_scaledSize;
+	}
+
+	void setScaledSize( QSize scaledSize );
+
+	/*!
+	 * \brief Sets JPEG quality (0-100) for Tight encoded rects or -1 to send raw rects only
+	 */
+	void setJpegQuality( int quality )
+	{
+		m_jpegQuality = quality;
+	}
+
+	/*!
+	 * \brief Returns JPEG quality for given Tight quality level (0-9) as used by TightVNC
+	 */
+	static int jpegQualityForLevel( int qualityLevel );
+
+	bool isClientFramebufferScaled() const
+	{
+		return m_clientFramebufferScaled;
+	}
+
+	void resize( QSize framebufferSize );
+
+	/*!
+	 * \brief Applies a FramebufferUpdate message received from the VNC server
+	 * \return false if the message could not be applied completely so that a full update has to be requested
+	 */
+	bool handleFramebufferUpdate( const QByteArray& message );
+
+	/*!
+	 * \brief Returns a FramebufferUpdate message for the client covering all pending changes or an empty QByteArray
+	 */
+	QByteArray scaledFramebufferUpdate();
+
+	QPoint mapToFramebuffer( QPoint scaledPos ) const;
+
+	static QByteArray resizeFramebufferMessage( QSize size );
+
+private:
+	bool applyRawRect( QIODevice& device, const QRect& rect );
+	bool applyCopyRect( QIODevice& device, const QRect& rect );
+
+	bool writeJpegRect( QIODevice& device, const QRect& rect );
+	static void writeRectHeader( QIODevice& device, const QRect& rect, int32_t encoding );
+
+	static QSize effectiveScaledSize( QSize framebufferSize, QSize scaledSize );
+
+	QImage m_framebuffer;
+	QImage m_scaledFramebuffer;
+	QSize m_scaledSize;
+	QRegion m_damage;
+	bool m_sizeChanged;
+	bool m_clientFramebufferScaled;
+	int m_jpegQuality;
+
+} ;
+
+#endif
@@ -26,7 +26,10 @@
 #include <QHostAddress>
 #include <QTcpSocket>
 #include <QTimer>
+#include <QtEndian>
 
+#include "ScaledFramebuffer.h"
+#include "VeyonRfbExt.h"
 #include "VncClientProtocol.h"
 #include "VncProxyConnection.h"
 #include "VncServerProtocol.h"
@@ -43,7 +46,13 @@ VncProxyConnection::VncProxyConnection( QTcpSocket* clientSocket,
 									 std::pair<int, int>( rfbKeyEvent, sz_rfbKeyEventMsg ),
 									 std::pair<int, int>( rfbPointerEvent, sz_rfbPointerEventMsg ),
 									 std::pair<int, int>( rfbXvp, sz_rfbXvpMsg ),
-									 } )
+									 } ),
+	m_clientSetEncodingsMessage(),
+	m_clientPixelFormat(),
+	m_clientPixelFormatValid( false ),
+	m_scaledFramebufferAcknowledged( false ),
+	m_clientJpegQuality( -1 ),
+	m_scaledFramebuffer( nullptr )
 {
 	connect( m_proxyClientSocket, &QTcpSocket::readyRead, this, &VncProxyConnection::readFromClient );
 	connect( m_vncServerSocket, &QTcpSocket::readyRead, this, &VncProxyConnection::readFromServer );
@@ -64,6 +73,8 @@ VncProxyConnection::~VncProxyConnection()
 
 	delete m_vncServerSocket;
 	delete m_proxyClientSocket;
+
+	delete m_scaledFramebuffer;
 }
 
 
@@ -190,22 +201,19 @@ bool VncProxyConnection::receiveClientMessage()
 	switch( messageType )
 	{
 	case rfbSetEncodings:
-		if( socket->bytesAvailable() >= sz_rfbSetEncodingsMsg )
-		{
-			rfbSetEncodingsMsg setEncodingsMessage;
-			if( socket->peek( (char *) &setEncodingsMessage, sz_rfbSetEncodingsMsg ) == sz_rfbSetEncodingsMsg )
-			{
-				const auto nEncodings = qFromBigEndian(setEncodingsMessage.nEncodings);
-				if( nEncodings > MAX_ENCODINGS )
-				{
-					qCritical( "VncProxyConnection::receiveClientMessage(): received too many encodings from client" );
-					socket->close();
-					return false;
-				}
-				return forwardDataToServer( sz_rfbSetEncodingsMsg + nEncodings * sizeof(uint32_t) );
-			}
-		}
-		break;
+		return receiveSetEncodingsMessage();
+
+	case rfbSetPixelFormat:
+		return receiveSetPixelFormatMessage();
+
+	case rfbFramebufferUpdateRequest:
+		return receiveFramebufferUpdateRequestMessage();
+
+	case rfbPointerEvent:
+		return receivePointerEventMessage();
+
+	case rfbVeyonScaledFramebuffer:
+		return receiveSetScaledSizeMessage();
 
 	default:
 		if( m_rfbClientToServerMessageSizes.contains( messageType ) == false )
@@ -227,10 +235,314 @@ bool VncProxyConnection::receiveServerMessage()
 {
 	if( clientProtocol().receiveMessage() )
 	{
-		m_proxyClientSocket->write( clientProtocol().lastMessage() );
+		if( m_scaledFramebuffer == nullptr )
+		{
+			m_proxyClientSocket->write( clientProtocol().lastMessage() );
+		}
+		else
+		{
+			switch( clientProtocol().lastMessageType() )
+			{
+			case rfbFramebufferUpdate:
+				handleScaledFramebufferUpdate();
+				break;
+
+			case rfbResizeFrameBuffer:
+				// client only knows about the scaled framebuffer
+				m_scaledFramebuffer->resize( QSize( clientProtocol().framebufferWidth(), clientProtocol().framebufferHeight() ) );
+				clientProtocol().requestFramebufferUpdate( false );
+				break;
+
+			default:
+				m_proxyClientSocket->write( clientProtocol().lastMessage() );
+				break;
+			}
+		}
 
 		return true;
 	}
 
 	return false;
 }
+
+
+
+bool VncProxyConnection::receiveSetEncodingsMessage()
+{
+	auto socket = proxyClientSocket();
+
+	rfbSetEncodingsMsg setEncodingsMessage;
+	if( socket->bytesAvailable() < sz_rfbSetEncodingsMsg ||
+			socket->peek( (char *) &setEncodingsMessage, sz_rfbSetEncodingsMsg ) != sz_rfbSetEncodingsMsg )
+	{
+		return false;
+	}
+
+	const auto nEncodings = qFromBigEndian(setEncodingsMessage.nEncodings);
+	if( nEncodings > MAX_ENCODINGS )
+	{
+		qCritical( "VncProxyConnection::receiveSetEncodingsMessage(): received too many encodings from client" );
+		socket->close();
+		return false;
+	}
+
+	const qint64 messageSize = sz_rfbSetEncodingsMsg + nEncodings * sizeof(uint32_t);
+	if( socket->bytesAvailable() < messageSize )
+	{
+		return false;
+	}
+
+	m_clientSetEncodingsMessage = socket->read( messageSize ); // Flawfinder: ignore
+	if( m_clientSetEncodingsMessage.size() != messageSize )
+	{
+		return false;
+	}
+
+	bool scaledFramebufferSupported = false;
+	bool tightSupported = false;
+	int qualityLevel = -1;
+
+	const auto encodings = reinterpret_cast<const uint32_t *>( m_clientSetEncodingsMessage.constData() + sz_rfbSetEncodingsMsg );
+	for( int i = 0; i < nEncodings; ++i )
+	{
+		const auto encoding = qFromBigEndian( encodings[i] );
+		if( encoding == rfbEncodingVeyonScaledFramebuffer )
+		{
+			scaledFramebufferSupported = true;
+		}
+		else if( encoding == rfbEncodingTight )
+		{
+			tightSupported = true;
+		}
+		else if( encoding >= rfbEncodingQualityLevel0 && encoding <= rfbEncodingQualityLevel9 )
+		{
+			qualityLevel = static_cast<int>( encoding - rfbEncodingQualityLevel0 );
+		}
+	}
+
+	// clients announce JPEG support through a quality level
+	m_clientJpegQuality = tightSupported && qualityLevel >= 0 ? ScaledFramebuffer::jpegQualityForLevel( qualityLevel ) : -1;
+	if( m_scaledFramebuffer )
+	{
+		m_scaledFramebuffer->setJpegQuality( m_clientJpegQuality );
+	}
+
+	// server has to stick to encodings we can decode while scaling - client's
+	// encodings will be restored once scaling is stopped
+	if( m_scaledFramebuffer == nullptr &&
+			m_vncServerSocket->write( m_clientSetEncodingsMessage ) != messageSize )
+	{
+		return false;
+	}
+
+	if( scaledFramebufferSupported && m_scaledFramebufferAcknowledged == false )
+	{
+		rfbVeyonScaledFramebufferAckMsg ackMessage;
+		ackMessage.type = rfbVeyonScaledFramebuffer;
+		ackMessage.pad1 = 0;
+		ackMessage.pad2 = 0;
+
+		m_proxyClientSocket->write( reinterpret_cast<const char *>( &ackMessage ), sz_rfbVeyonScaledFramebufferAckMsg );
+		m_scaledFramebufferAcknowledged = true;
+	}
+
+	return true;
+}
+
+
+
+bool VncProxyConnection::receiveSetPixelFormatMessage()
+{
+	rfbSetPixelFormatMsg message;
+	if( proxyClientSocket()->peek( (char *) &message, sz_rfbSetPixelFormatMsg ) != sz_rfbSetPixelFormatMsg )
+	{
+		return false;
+	}
+
+	if( forwardDataToServer( sz_rfbSetPixelFormatMsg ) == false )
+	{
+		return false;
+	}
+
+	m_clientPixelFormat = message.format;
+	m_clientPixelFormatValid = true;
+
+	if( m_scaledFramebuffer && ScaledFramebuffer::isPixelFormatSupported( m_clientPixelFormat ) == false )
+	{
+		stopScaling();
+	}
+
+	return true;
+}
+
+
+
+bool VncProxyConnection::receiveFramebufferUpdateRequestMessage()
+{
+	if( m_scaledFramebuffer == nullptr )
+	{
+		return forwardDataToServer( sz_rfbFramebufferUpdateRequestMsg );
+	}
+
+	rfbFramebufferUpdateRequestMsg message;
+	if( proxyClientSocket()->read( (char *) &message, sz_rfbFramebufferUpdateRequestMsg ) != sz_rfbFramebufferUpdateRequestMsg ) // Flawfinder: ignore
+	{
+		return false;
+	}
+
+	// requested area refers to scaled framebuffer so request updates for the whole framebuffer
+	clientProtocol().requestFramebufferUpdate( message.incremental );
+
+	return true;
+}
+
+
+
+bool VncProxyConnection::receivePointerEventMessage()
+{
+	if( m_scaledFramebuffer == nullptr )
+	{
+		return forwardDataToServer( sz_rfbPointerEventMsg );
+	}
+
+	rfbPointerEventMsg message;
+	if( proxyClientSocket()->read( (char *) &message, sz_rfbPointerEventMsg ) != sz_rfbPointerEventMsg ) // Flawfinder: ignore
+	{
+		return false;
+	}
+
+	const auto pos = m_scaledFramebuffer->mapToFramebuffer( QPoint( qFromBigEndian( message.x ), qFromBigEndian( message.y ) ) );
+	message.x = qToBigEndian<uint16_t>( static_cast<uint16_t>( pos.x() ) );
+	message.y = qToBigEndian<uint16_t>( static_cast<uint16_t>( pos.y() ) );
+
+	return m_vncServerSocket->write( (const char *) &message, sz_rfbPointerEventMsg ) == sz_rfbPointerEventMsg;
+}
+
+
+
+bool VncProxyConnection::receiveSetScaledSizeMessage()
+{
+	rfbVeyonSetScaledSizeMsg message;
+	if( proxyClientSocket()->bytesAvailable() < sz_rfbVeyonSetScaledSizeMsg ||
+			proxyClientSocket()->read( (char *) &message, sz_rfbVeyonSetScaledSizeMsg ) != sz_rfbVeyonSetScaledSizeMsg ) // Flawfinder: ignore
+	{
+		return false;
+	}
+
+	const QSize scaledSize( qFromBigEndian( message.width ), qFromBigEndian( message.height ) );
+
+	if( scaledSize.isEmpty() )
+	{
+		stopScaling();
+	}
+	else if( m_scaledFramebuffer )
+	{
+		m_scaledFramebuffer->setScaledSize( scaledSize );
+		m_proxyClientSocket->write( m_scaledFramebuffer->scaledFramebufferUpdate() );
+	}
+	else
+	{
+		startScaling( scaledSize );
+	}
+
+	return true;
+}
+
+
+
+void VncProxyConnection::startScaling( QSize scaledSize )
+{
+	// VncClientProtocol decodes rects based on the pixel format announced by the server
+	if( ScaledFramebuffer::isPixelFormatSupported( clientPixelFormat() ) == false ||
+			serverPixelFormat().bitsPerPixel != clientPixelFormat().bitsPerPixel )
+	{
+		qWarning( "VncProxyConnection::startScaling(): pixel format of client not supported" );
+		return;
+	}
+
+	m_scaledFramebuffer = new ScaledFramebuffer( QSize( clientProtocol().framebufferWidth(), clientProtocol().framebufferHeight() ),
+												 scaledSize );
+	m_scaledFramebuffer->setJpegQuality( m_clientJpegQuality );
+
+	// local connection to server so raw encoding is the cheapest one to decode
+	clientProtocol().setEncodings( { rfbEncodingCopyRect, rfbEncodingRaw, rfbEncodingNewFBSize } );
+	clientProtocol().requestFramebufferUpdate( false );
+}
+
+
+
+void VncProxyConnection::stopScaling()
+{
+	if( m_scaledFramebuffer == nullptr )
+	{
+		return;
+	}
+
+	delete m_scaledFramebuffer;
+	m_scaledFramebuffer = nullptr;
+
+	// restore encodings of client and let it resize its framebuffer to the original size
+	// which makes it request a full update afterwards
+	if( m_clientSetEncodingsMessage.isEmpty() == false )
+	{
+		m_vncServerSocket->write( m_clientSetEncodingsMessage );
+	}
+
+	m_proxyClientSocket->write( ScaledFramebuffer::resizeFramebufferMessage(
+									QSize( clientProtocol().framebufferWidth(), clientProtocol().framebufferHeight() ) ) );
+}
+
+
+
+void VncProxyConnection::handleScaledFramebufferUpdate()
+{
+	if( m_scaledFramebuffer->handleFramebufferUpdate( clientProtocol().lastMessage() ) == false )
+	{
+		if( m_scaledFramebuffer->isClientFramebufferScaled() == false )
+		{
+			// update has been encoded with client's encodings before scaling started - forward it as client
+			// still has the full size framebuffer and may have to keep track of encoder states (e.g. zlib streams)
+			m_proxyClientSocket->write( clientProtocol().lastMessage() );
+		}
+		else
+		{
+			clientProtocol().requestFramebufferUpdate( false );
+		}
+		return;
+	}
+
+	const auto update = m_scaledFramebuffer->scaledFramebufferUpdate();
+	if( update.isEmpty() == false )
+	{
+		m_proxyClientSocket->write( update );
+	}
+}
+
+
+
+rfbPixelFormat VncProxyConnection::serverPixelFormat()
+{
+	rfbServerInitMsg serverInitMessage;
+	memset( &serverInitMessage, 0, sizeof(serverInitMessage) );
+
+	const auto& message = clientProtocol().serverInitMessage();
+	if( message.size() >= sz_rfbServerInitMsg )
+	{
+		memcpy( &serverInitMessage, message.constData(), sz_rfbServerInitMsg ); // Flawfinder: ignore
+	}
+
+	return serverInitMessage.format;
+}
+
+
+
+rfbPixelFormat VncProxyConnection::clientPixelFormat()
+{
+	if( m_clientPixelFormatValid )
+	{
+		return m_clientPixelFormat;
+	}
+
+	// client did not change pixel format so far and uses the one announced by the server
+	return serverPixelFormat();
+}
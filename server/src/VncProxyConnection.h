@@ -25,11 +25,16 @@
 #ifndef VNC_PROXY_CONNECTION_H
 #define VNC_PROXY_CONNECTION_H
 
+#include <QSize>
+
+#include "rfb/rfbproto.h"
+
 #include "VeyonCore.h"
 
 class QBuffer;
 class QTcpSocket;
 
+class ScaledFramebuffer;
 class VncClientProtocol;
 class VncServerProtocol;
 
@@ -72,11 +77,30 @@ protected:
 	virtual VncServerProtocol& serverProtocol() = 0;
 
 private:
+	bool receiveSetEncodingsMessage();
+	bool receiveSetPixelFormatMessage();
+	bool receiveFramebufferUpdateRequestMessage();
+	bool receivePointerEventMessage();
+	bool receiveSetScaledSizeMessage();
+
+	void startScaling( QSize scaledSize );
+	void stopScaling();
+	void handleScaledFramebufferUpdate();
+	rfbPixelFormat serverPixelFormat();
+	rfbPixelFormat clientPixelFormat();
+
 	QTcpSocket* m_proxyClientSocket;
 	QTcpSocket* m_vncServerSocket;
 
 	const QMap<int, int> m_rfbClientToServerMessageSizes;
 
+	QByteArray m_clientSetEncodingsMessage;
+	rfbPixelFormat m_clientPixelFormat;
+	bool m_clientPixelFormatValid;
+	bool m_scaledFramebufferAcknowledged;
+	int m_clientJpegQuality;
+	ScaledFramebuffer* m_scaledFramebuffer;
+
 signals:
 	void clientConnectionClosed();
 	void serverConnectionClosed();
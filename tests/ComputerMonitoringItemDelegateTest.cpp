@@ -0,0 +1,256 @@
+/*
+ * ComputerMonitoringItemDelegateTest.cpp - unit tests and benchmarks for ComputerMonitoringItemDelegate
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QApplication>
+#include <QPainter>
+#include <QRegExp>
+#include <QtTest>
+
+#include "ComputerMonitoringItemDelegate.h"
+#include "ComputerMonitoringItemDelegateTest.h"
+
+
+MonitoringModelStub::MonitoringModelStub( int count, QObject* parent ) :
+	QAbstractListModel( parent ),
+	m_computers()
+{
+	m_computers.reserve( count );
+
+	for( int row = 0; row < count; ++row )
+	{
+		QImage screen( ScreenWidth, ScreenHeight, QImage::Format_RGB32 );
+		screen.fill( QColor::fromHsv( row * 7 % 360, 128, 255 ) );
+
+		m_computers.append( { QUuid::createUuid(),
+							  QStringLiteral( "Computer %1" ).arg( row ),
+							  QStringLiteral( "student%1 (Student %1)" ).arg( row ),
+							  0,
+							  screen } );
+	}
+}
+
+
+
+int MonitoringModelStub::rowCount( const QModelIndex& parent ) const
+{
+	return parent.isValid() ? 0 : m_computers.count();
+}
+
+
+
+QVariant MonitoringModelStub::data( const QModelIndex& index, int role ) const
+{
+	if( index.isValid() == false || index.row() >= m_computers.count() )
+	{
+		return QVariant();
+	}
+
+	const auto& computer = m_computers[index.row()];
+
+	switch( role )
+	{
+	case Qt::DisplayRole: return displayText( computer );
+	case Qt::DecorationRole: return computer.screen;
+	case UidRole: return computer.uid;
+	case ScreenGenerationRole: return computer.screenGeneration;
+	case ScreenActivityRole: return 0;
+	default: break;
+	}
+
+	return QVariant();
+}
+
+
+
+void MonitoringModelStub::setUser( int row, const QString& user )
+{
+	m_computers[row].user = user;
+
+	emit dataChanged( index( row ), index( row ), { Qt::DisplayRole } );
+}
+
+
+
+QString MonitoringModelStub::displayText( const Computer& computer ) const
+{
+	// same as ComputerControlListModel::computerDisplayRole()
+	auto user = computer.user;
+
+	QRegExp fullNameRX( QStringLiteral("(.*) \\((.*)\\)") );
+	if( fullNameRX.indexIn( user ) >= 0 )
+	{
+		if( fullNameRX.cap( 2 ).isEmpty() == false )
+		{
+			user = fullNameRX.cap( 2 );
+		}
+		else
+		{
+			user = fullNameRX.cap( 1 );
+		}
+	}
+
+	return QStringLiteral("%1 - %2").arg( user, computer.name );
+}
+
+
+
+void ComputerMonitoringItemDelegateTest::displayTextChangeNeedsRemoval()
+{
+	MonitoringModelStub model( 1 );
+
+	const auto font = QApplication::font();
+	const auto uid = model.index( 0 ).data( MonitoringModelStub::UidRole ).toUuid();
+
+	ComputerMonitoringItemDelegate delegate( MonitoringModelStub::UidRole,
+											 MonitoringModelStub::ScreenGenerationRole,
+											 MonitoringModelStub::ScreenActivityRole );
+	const auto before = paintItem( delegate, model, 0, font );
+
+	// e.g. other user logged on without new screen content
+	model.setUser( 0, QStringLiteral("teacher (Teacher)") );
+
+	// display text is not queried for cached items
+	QCOMPARE( paintItem( delegate, model, 0, font ), before );
+
+	// as done by ComputerMonitoringView on dataChanged()
+	delegate.removeCachedItem( uid );
+
+	const auto after = paintItem( delegate, model, 0, font );
+
+	ComputerMonitoringItemDelegate uncachedDelegate( MonitoringModelStub::UidRole,
+													 MonitoringModelStub::ScreenGenerationRole,
+													 MonitoringModelStub::ScreenActivityRole );
+
+	QVERIFY( before != after );
+	QCOMPARE( after, paintItem( uncachedDelegate, model, 0, font ) );
+}
+
+
+
+void ComputerMonitoringItemDelegateTest::fontChangeUpdatesCache()
+{
+	MonitoringModelStub model( 1 );
+
+	auto font = QApplication::font();
+
+	ComputerMonitoringItemDelegate delegate( MonitoringModelStub::UidRole,
+											 MonitoringModelStub::ScreenGenerationRole,
+											 MonitoringModelStub::ScreenActivityRole );
+	const auto before = paintItem( delegate, model, 0, font );
+
+	font.setBold( true );
+	font.setPointSize( font.pointSize() + 4 );
+
+	const auto after = paintItem( delegate, model, 0, font );
+
+	ComputerMonitoringItemDelegate uncachedDelegate( MonitoringModelStub::UidRole,
+													 MonitoringModelStub::ScreenGenerationRole,
+													 MonitoringModelStub::ScreenActivityRole );
+
+	QVERIFY( before != after );
+	QCOMPARE( after, paintItem( uncachedDelegate, model, 0, font ) );
+}
+
+
+
+void ComputerMonitoringItemDelegateTest::benchmarkRepaint_data()
+{
+	QTest::addColumn<int>( "itemCount" );
+	QTest::addColumn<bool>( "cached" );
+
+	for( auto itemCount : { 100, 1000, 5000 } )
+	{
+		QTest::newRow( qPrintable( QStringLiteral( "%1 items unchanged" ).arg( itemCount ) ) ) << itemCount << true;
+		QTest::newRow( qPrintable( QStringLiteral( "%1 items changed" ).arg( itemCount ) ) ) << itemCount << false;
+	}
+}
+
+
+
+void ComputerMonitoringItemDelegateTest::benchmarkRepaint()
+{
+	QFETCH(int, itemCount);
+	QFETCH(bool, cached);
+
+	MonitoringModelStub model( itemCount );
+
+	ComputerMonitoringItemDelegate delegate( MonitoringModelStub::UidRole,
+											 MonitoringModelStub::ScreenGenerationRole,
+											 MonitoringModelStub::ScreenActivityRole );
+
+	QStyleOptionViewItem option;
+	option.state = QStyle::State_Enabled;
+	option.palette = QApplication::palette();
+	option.font = QApplication::font();
+	option.fontMetrics = QFontMetrics( option.font );
+	option.decorationSize = QSize( MonitoringModelStub::ScreenWidth, MonitoringModelStub::ScreenHeight );
+	option.rect = QRect( QPoint( 0, 0 ), delegate.sizeHint( option, model.index( 0 ) ) );
+
+	QImage canvas( option.rect.size(), QImage::Format_ARGB32_Premultiplied );
+	QPainter painter( &canvas );
+
+	// warm up cache
+	for( int row = 0; row < itemCount; ++row )
+	{
+		delegate.paint( &painter, option, model.index( row ) );
+	}
+
+	QBENCHMARK {
+		if( cached == false )
+		{
+			delegate.clearCache();
+		}
+
+		for( int row = 0; row < itemCount; ++row )
+		{
+			delegate.paint( &painter, option, model.index( row ) );
+		}
+	}
+}
+
+
+
+QImage ComputerMonitoringItemDelegateTest::paintItem( const ComputerMonitoringItemDelegate& delegate,
+													  const MonitoringModelStub& model, int row, const QFont& font )
+{
+	QStyleOptionViewItem option;
+	option.state = QStyle::State_Enabled;
+	option.palette = QApplication::palette();
+	option.font = font;
+	option.fontMetrics = QFontMetrics( font );
+	option.decorationSize = QSize( MonitoringModelStub::ScreenWidth, MonitoringModelStub::ScreenHeight );
+	option.rect = QRect( QPoint( 0, 0 ), delegate.sizeHint( option, model.index( row ) ) );
+
+	QImage image( option.rect.size(), QImage::Format_ARGB32_Premultiplied );
+	image.fill( Qt::white );
+
+	QPainter painter( &image );
+	delegate.paint( &painter, option, model.index( row ) );
+	painter.end();
+
+	return image;
+}
+
+
+QTEST_MAIN(ComputerMonitoringItemDelegateTest)
@@ -0,0 +1,96 @@
+/*
+ * ComputerMonitoringItemDelegateTest.h - unit tests and benchmarks for ComputerMonitoringItemDelegate
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef COMPUTER_MONITORING_ITEM_DELEGATE_TEST_H
+#define COMPUTER_MONITORING_ITEM_DELEGATE_TEST_H
+
+#include <QAbstractListModel>
+#include <QFont>
+#include <QImage>
+#include <QUuid>
+#include <QVector>
+
+class ComputerMonitoringItemDelegate;
+
+/*!
+ * \brief Stands in for ComputerControlListModel with roles of comparable cost
+ *
+ * Like the real model, the display role extracts the user's full name with a regular expression on
+ * every call and the decoration role returns a copy of the current screen image.
+ */
+class MonitoringModelStub : public QAbstractListModel
+{
+public:
+	enum {
+		UidRole = Qt::UserRole,
+		ScreenGenerationRole,
+		ScreenActivityRole
+	};
+
+	enum {
+		ScreenWidth = 160,
+		ScreenHeight = 90
+	};
+
+	explicit MonitoringModelStub( int count, QObject* parent = nullptr );
+
+	int rowCount( const QModelIndex& parent = QModelIndex() ) const override;
+	QVariant data( const QModelIndex& index, int role ) const override;
+
+	void setUser( int row, const QString& user );
+
+private:
+	struct Computer
+	{
+		QUuid uid;
+		QString name;
+		QString user;
+		quint32 screenGeneration;
+		QImage screen;
+	};
+
+	QString displayText( const Computer& computer ) const;
+
+	QVector<Computer> m_computers;
+
+} ;
+
+
+class ComputerMonitoringItemDelegateTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void displayTextChangeNeedsRemoval();
+	void fontChangeUpdatesCache();
+
+	void benchmarkRepaint_data();
+	void benchmarkRepaint();
+
+private:
+	static QImage paintItem( const ComputerMonitoringItemDelegate& delegate, const MonitoringModelStub& model,
+							 int row, const QFont& font );
+
+} ;
+
+#endif
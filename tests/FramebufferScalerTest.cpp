@@ -0,0 +1,366 @@
+/*
+ * FramebufferScalerTest.cpp - unit tests and benchmarks for FramebufferScaler
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QtTest>
+
+#include <cstring>
+
+#include "FramebufferScaler.h"
+#include "FramebufferScalerTest.h"
+
+Q_DECLARE_METATYPE(FramebufferScaler::Kernel)
+
+static const char* kernelName( FramebufferScaler::Kernel kernel )
+{
+	switch( kernel )
+	{
+	case FramebufferScaler::GenericKernel: return "generic";
+	case FramebufferScaler::Sse2Kernel: return "sse2";
+	case FramebufferScaler::Avx2Kernel: return "avx2";
+	case FramebufferScaler::NeonKernel: return "neon";
+	default: break;
+	}
+
+	return "unknown";
+}
+
+
+
+void FramebufferScalerTest::cleanup()
+{
+	FramebufferScaler::resetKernel();
+}
+
+
+
+void FramebufferScalerTest::scaleFull_data()
+{
+	addKernelAndSizeColumns();
+}
+
+
+
+void FramebufferScalerTest::scaleFull()
+{
+	QFETCH(FramebufferScaler::Kernel, kernel);
+	QFETCH(QSize, sourceSize);
+	QFETCH(QSize, targetSize);
+
+	if( FramebufferScaler::setKernel( kernel ) == false )
+	{
+		QSKIP( "kernel not supported on this system" );
+	}
+
+	const auto source = randomImage( sourceSize );
+
+	const auto scaled = FramebufferScaler::scaled( source, targetSize );
+
+	QCOMPARE( scaled.size(), targetSize );
+	QCOMPARE( scaled.format(), source.format() );
+
+	// float normalization may round differently than integer division
+	QVERIFY( maximumDifference( scaled, referenceScaled( source, targetSize ) ) <= 1 );
+}
+
+
+
+void FramebufferScalerTest::scalePartial_data()
+{
+	addKernelAndSizeColumns();
+}
+
+
+
+void FramebufferScalerTest::scalePartial()
+{
+	QFETCH(FramebufferScaler::Kernel, kernel);
+	QFETCH(QSize, sourceSize);
+	QFETCH(QSize, targetSize);
+
+	if( FramebufferScaler::setKernel( kernel ) == false )
+	{
+		QSKIP( "kernel not supported on this system" );
+	}
+
+	auto source = randomImage( sourceSize );
+	auto target = FramebufferScaler::scaled( source, targetSize );
+
+	// change part of the source and only rescale the affected target area
+	const auto damage = QRect( sourceSize.width() / 3, sourceSize.height() / 4,
+							   sourceSize.width() / 3 + 1, sourceSize.height() / 2 + 1 ).intersected( source.rect() );
+	const auto update = randomImage( damage.size() );
+	for( int y = 0; y < damage.height(); ++y )
+	{
+		memcpy( source.scanLine( damage.top() + y ) + damage.left() * 4, update.constScanLine( y ),
+				static_cast<size_t>( damage.width() * 4 ) );
+	}
+
+	const auto targetArea = FramebufferScaler::mapToTarget( damage, sourceSize, targetSize );
+	QVERIFY( FramebufferScaler::scale( source, target, targetArea ) );
+
+	// result has to match scaling the whole image, i.e. no stale pixels at area borders
+	QCOMPARE( target, FramebufferScaler::scaled( source, targetSize ) );
+	QVERIFY( maximumDifference( target, referenceScaled( source, targetSize ) ) <= 1 );
+}
+
+
+
+void FramebufferScalerTest::benchmarkFramebufferScaler_data()
+{
+	QTest::addColumn<FramebufferScaler::Kernel>( "kernel" );
+	QTest::addColumn<QSize>( "sourceSize" );
+	QTest::addColumn<QSize>( "targetSize" );
+
+	const auto sizes = benchmarkSizes();
+
+	for( int kernel = 0; kernel < FramebufferScaler::KernelCount; ++kernel )
+	{
+		const auto k = static_cast<FramebufferScaler::Kernel>( kernel );
+
+		for( const auto& size : sizes )
+		{
+			QTest::newRow( QStringLiteral( "%1 %2x%3 -> %4x%5" ).
+						   arg( QLatin1String( kernelName( k ) ) ).
+						   arg( size.first.width() ).arg( size.first.height() ).
+						   arg( size.second.width() ).arg( size.second.height() ).toUtf8().constData() )
+					<< k << size.first << size.second;
+		}
+	}
+}
+
+
+
+void FramebufferScalerTest::benchmarkFramebufferScaler()
+{
+	QFETCH(FramebufferScaler::Kernel, kernel);
+	QFETCH(QSize, sourceSize);
+	QFETCH(QSize, targetSize);
+
+	if( FramebufferScaler::setKernel( kernel ) == false )
+	{
+		QSKIP( "kernel not supported on this system" );
+	}
+
+	const auto source = randomImage( sourceSize );
+	QImage target( targetSize, source.format() );
+
+	QBENCHMARK {
+		FramebufferScaler::scale( source, target, target.rect() );
+	}
+}
+
+
+
+void FramebufferScalerTest::benchmarkQImageScaled_data()
+{
+	QTest::addColumn<bool>( "smooth" );
+	QTest::addColumn<QSize>( "sourceSize" );
+	QTest::addColumn<QSize>( "targetSize" );
+
+	const auto sizes = benchmarkSizes();
+
+	for( auto smooth : { true, false } )
+	{
+		for( const auto& size : sizes )
+		{
+			QTest::newRow( QStringLiteral( "%1 %2x%3 -> %4x%5" ).
+						   arg( smooth ? QStringLiteral("smooth") : QStringLiteral("fast") ).
+						   arg( size.first.width() ).arg( size.first.height() ).
+						   arg( size.second.width() ).arg( size.second.height() ).toUtf8().constData() )
+					<< smooth << size.first << size.second;
+		}
+	}
+}
+
+
+
+void FramebufferScalerTest::benchmarkQImageScaled()
+{
+	QFETCH(bool, smooth);
+	QFETCH(QSize, sourceSize);
+	QFETCH(QSize, targetSize);
+
+	const auto source = randomImage( sourceSize );
+	const auto mode = smooth ? Qt::SmoothTransformation : Qt::FastTransformation;
+
+	QBENCHMARK {
+		source.scaled( targetSize, Qt::IgnoreAspectRatio, mode );
+	}
+}
+
+
+
+QList<QPair<QSize, QSize> > FramebufferScalerTest::benchmarkSizes()
+{
+	// common screen resolutions of monitored computers
+	const QList<QSize> sourceSizes( {
+		QSize( 1280, 1024 ),
+		QSize( 1920, 1080 ),
+		QSize( 2560, 1440 ),
+		QSize( 3840, 2160 )
+	} );
+
+	// thumbnail widths produced by the size slider of the monitoring view, i.e. minimum, default
+	// and maximum of ComputerMonitoringView plus an intermediate size - heights as calculated by
+	// ComputerControlListModel::computerScreenSize()
+	const QList<int> thumbnailWidths( { 50, 150, 320, 1000 } );
+
+	QList<QPair<QSize, QSize> > sizes;
+	sizes.reserve( sourceSizes.size() * thumbnailWidths.size() );
+
+	for( const auto& sourceSize : sourceSizes )
+	{
+		for( auto width : thumbnailWidths )
+		{
+			sizes.append( qMakePair( sourceSize, QSize( width, width * 9 / 16 ) ) );
+		}
+	}
+
+	return sizes;
+}
+
+
+
+void FramebufferScalerTest::addKernelAndSizeColumns()
+{
+	QTest::addColumn<FramebufferScaler::Kernel>( "kernel" );
+	QTest::addColumn<QSize>( "sourceSize" );
+	QTest::addColumn<QSize>( "targetSize" );
+
+	const QList<QPair<QSize, QSize> > sizes( {
+		// common thumbnail sizes
+		{ QSize( 1920, 1080 ), QSize( 320, 180 ) },
+		{ QSize( 1366, 768 ), QSize( 251, 141 ) },
+		// odd sizes exercising the non-vectorized remainders
+		{ QSize( 37, 23 ), QSize( 7, 5 ) },
+		// no reduction
+		{ QSize( 64, 48 ), QSize( 64, 48 ) },
+		// boxes too high for 16 bit accumulators
+		{ QSize( 640, 1000 ), QSize( 4, 3 ) }
+	} );
+
+	for( int kernel = 0; kernel < FramebufferScaler::KernelCount; ++kernel )
+	{
+		const auto k = static_cast<FramebufferScaler::Kernel>( kernel );
+
+		for( const auto& size : sizes )
+		{
+			QTest::newRow( QStringLiteral( "%1 %2x%3 -> %4x%5" ).
+						   arg( QLatin1String( kernelName( k ) ) ).
+						   arg( size.first.width() ).arg( size.first.height() ).
+						   arg( size.second.width() ).arg( size.second.height() ).toUtf8().constData() )
+					<< k << size.first << size.second;
+		}
+	}
+}
+
+
+
+QImage FramebufferScalerTest::randomImage( QSize size )
+{
+	QImage image( size, QImage::Format_RGB32 );
+
+	// deterministic pseudo random content
+	quint32 state = static_cast<quint32>( size.width() * 65521 + size.height() );
+
+	for( int y = 0; y < image.height(); ++y )
+	{
+		auto line = reinterpret_cast<quint32 *>( image.scanLine( y ) );
+		for( int x = 0; x < image.width(); ++x )
+		{
+			state = state * 1664525 + 1013904223;
+			line[x] = state;
+		}
+	}
+
+	return image;
+}
+
+
+
+QImage FramebufferScalerTest::referenceScaled( const QImage& source, QSize targetSize )
+{
+	QImage target( targetSize, source.format() );
+
+	for( int y = 0; y < targetSize.height(); ++y )
+	{
+		const auto top = y * source.height() / targetSize.height();
+		const auto bottom = ( y + 1 ) * source.height() / targetSize.height();
+
+		for( int x = 0; x < targetSize.width(); ++x )
+		{
+			const auto left = x * source.width() / targetSize.width();
+			const auto right = ( x + 1 ) * source.width() / targetSize.width();
+
+			quint64 sum[4] = { 0, 0, 0, 0 };
+			for( int sy = top; sy < bottom; ++sy )
+			{
+				const auto line = source.constScanLine( sy );
+				for( int sx = left; sx < right; ++sx )
+				{
+					for( int c = 0; c < 4; ++c )
+					{
+						sum[c] += line[sx*4+c];
+					}
+				}
+			}
+
+			const auto area = static_cast<quint64>( ( right - left ) * ( bottom - top ) );
+			auto pixel = target.scanLine( y ) + x * 4;
+			for( int c = 0; c < 4; ++c )
+			{
+				pixel[c] = static_cast<uchar>( ( sum[c] + area / 2 ) / area );
+			}
+		}
+	}
+
+	return target;
+}
+
+
+
+int FramebufferScalerTest::maximumDifference( const QImage& first, const QImage& second )
+{
+	if( first.size() != second.size() )
+	{
+		return 256;
+	}
+
+	int difference = 0;
+
+	for( int y = 0; y < first.height(); ++y )
+	{
+		const auto firstLine = first.constScanLine( y );
+		const auto secondLine = second.constScanLine( y );
+		for( int i = 0; i < first.width() * 4; ++i )
+		{
+			difference = qMax( difference, qAbs( firstLine[i] - secondLine[i] ) );
+		}
+	}
+
+	return difference;
+}
+
+
+QTEST_GUILESS_MAIN(FramebufferScalerTest)
@@ -0,0 +1,60 @@
+/*
+ * FramebufferScalerTest.h - unit tests and benchmarks for FramebufferScaler
+ *
+ * Copyright (c) 2018 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - http://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#ifndef FRAMEBUFFER_SCALER_TEST_H
+#define FRAMEBUFFER_SCALER_TEST_H
+
+#include <QImage>
+#include <QList>
+#include <QObject>
+#include <QPair>
+
+class FramebufferScalerTest : public QObject
+{
+	Q_OBJECT
+private slots:
+	void cleanup();
+
+	void scaleFull_data();
+	void scaleFull();
+
+	void scalePartial_data();
+	void scalePartial();
+
+	void benchmarkFramebufferScaler_data();
+	void benchmarkFramebufferScaler();
+
+	void benchmarkQImageScaled_data();
+	void benchmarkQImageScaled();
+
+private:
+	static void addKernelAndSizeColumns();
+	static QList<QPair<QSize, QSize> > benchmarkSizes();
+	static QImage randomImage( QSize size );
+	static QImage referenceScaled( const QImage& source, QSize targetSize );
+	static int maximumDifference( const QImage& first, const QImage& second );
+
+} ;
+
+#endif